@@ -11,31 +11,155 @@
 
 #include "component.h"
 #include "particle_editor.h"
+#include "engine/random.h"
 
 #include <vector>
+#include <cstdint>
 #include <glm.hpp>
 
 // ------------------------------------------------------------------------- //
 
-// This should be divided into an Structure of Arrays when DOD will be implemented.
-/// @brief Structure containing the necessary data to simulate the behaviour of a particle.
-struct Particle {
-
-	glm::vec3 position_;
-	glm::vec3 velocity_;
-	glm::vec4 color_;
-	float life_time_;
-	float distance_; // From particle to camera position.
-	bool alive_;
-
-	Particle() {
-		position_ = glm::vec3(0.0f, 0.0f, -10000.0f);
-		velocity_ = glm::vec3();
-		color_ = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
-		life_time_ = 0.0f;
-		distance_ = 0.0f;
-		alive_ = false;
+struct ParticleUpdateParams;
+class VectorField;
+class SpatialHashGrid;
+class BarnesHutOctree;
+class ParticleEventQueue;
+class RadixSorter;
+
+// ------------------------------------------------------------------------- //
+
+/// @brief Keys of the over lifetime curves and gradients, time is the normalized age of the particle in [0, 1].
+struct ParticleColorKey {
+	float time;
+	glm::vec4 color;
+};
+
+struct ParticleFloatKey {
+	float time;
+	float value;
+};
+
+struct ParticleVectorKey {
+	float time;
+	glm::vec3 value;
+};
+
+/// @brief Point that pulls the particles with an inverse square falloff, negative strengths push them away.
+struct ParticleAttractor {
+	glm::vec3 position;
+	float strength;
+	/// @brief Squared radius of influence.
+	float radius_sq;
+};
+
+/// @brief Analytic shape in the system space that the particles can't go through.
+struct ParticleCollider {
+	enum Shape {
+		kShape_Plane = 0,
+		kShape_Sphere = 1,
+		kShape_Box = 2,
+	};
+
+	Shape shape;
+	/// @brief Plane with the particles on the side the normal points to, at distance from the origin along it.
+	glm::vec3 normal;
+	float distance;
+	/// @brief Sphere, side is 1 to keep the particles out of it and -1 to keep them inside.
+	glm::vec3 center;
+	float radius;
+	float side;
+	/// @brief Axis aligned box, particles are kept out of it.
+	glm::vec3 box_min;
+	glm::vec3 box_max;
+};
+
+/// @brief Level of detail used by a system from a distance to the camera, with less particles and simulation steps.
+struct ParticleLODTier {
+	float distance;
+	/// @brief Multiplier of the emission rate.
+	float spawn_rate_scale;
+	/// @brief Max alive particles, the ones above it are not killed but no more spawn until they die. 0 keeps the pool size.
+	int max_alive_particles;
+	/// @brief The system is simulated once every update_interval updates, with a step as long as all of them.
+	int update_interval;
+};
+
+/// @brief State of the particle that raised an event, in the space of its system.
+struct ParticleEventRecord {
+	glm::vec3 position;
+	glm::vec3 velocity;
+};
+
+// ------------------------------------------------------------------------- //
+
+/**
+* @brief Particles data stored as a Structure of Arrays.
+*				 Every attribute lives in its own aligned array so the update can stream linearly through them.
+*/
+struct ParticleData {
+
+	float* position_x_;
+	float* position_y_;
+	float* position_z_;
+	/// @brief Position before the last update step, used to interpolate between steps when rendering.
+	float* previous_position_x_;
+	float* previous_position_y_;
+	float* previous_position_z_;
+	float* velocity_x_;
+	float* velocity_y_;
+	float* velocity_z_;
+	float* color_r_;
+	float* color_g_;
+	float* color_b_;
+	float* color_a_;
+	float* life_time_;
+	/// @brief Key used to order the particles, from particle to camera position.
+	float* sort_key_;
+	/// @brief Position of the particle in the last draw order, moves with it when the pool is packed.
+	uint32_t* sort_rank_;
+	/// @brief Rank of the particles spawned after the last sort.
+	static constexpr uint32_t kUnsorted = 0xFFFFFFFFu;
+
+	ParticleData();
+	~ParticleData();
+	ParticleData(const ParticleData&) = delete;
+	ParticleData& operator=(const ParticleData&) = delete;
+
+	/// @brief Allocates all the arrays in a single aligned block and resets them to dead particles.
+	void allocate(int max_particles);
+	/// @brief Copies all the attributes of a particle into another one.
+	void copy(int dst_index, int src_index);
+	/// @brief Exchanges all the attributes of two particles.
+	void swap(int index_a, int index_b);
+	/// @brief Frees the memory block used by the arrays.
+	void release();
+
+	glm::vec3 getPosition(int index) const { return glm::vec3(position_x_[index], position_y_[index], position_z_[index]); }
+	glm::vec3 getPreviousPosition(int index) const {
+		return glm::vec3(previous_position_x_[index], previous_position_y_[index], previous_position_z_[index]);
 	}
+	/// @return Position between the previous and current update steps.
+	glm::vec3 getInterpolatedPosition(int index, float alpha) const {
+		return glm::mix(getPreviousPosition(index), getPosition(index), alpha);
+	}
+	glm::vec3 getVelocity(int index) const { return glm::vec3(velocity_x_[index], velocity_y_[index], velocity_z_[index]); }
+	glm::vec4 getColor(int index) const { return glm::vec4(color_r_[index], color_g_[index], color_b_[index], color_a_[index]); }
+
+	void setPosition(int index, glm::vec3 position) {
+		position_x_[index] = position.x; position_y_[index] = position.y; position_z_[index] = position.z;
+		previous_position_x_[index] = position.x; previous_position_y_[index] = position.y; previous_position_z_[index] = position.z;
+	}
+	void setVelocity(int index, glm::vec3 velocity) {
+		velocity_x_[index] = velocity.x; velocity_y_[index] = velocity.y; velocity_z_[index] = velocity.z;
+	}
+	void setColor(int index, glm::vec4 color) {
+		color_r_[index] = color.r; color_g_[index] = color.g; color_b_[index] = color.b; color_a_[index] = color.a;
+	}
+
+	/// @brief Number of particles that fit in the arrays.
+	int capacity_;
+	/// @brief Single aligned allocation that contains all the arrays.
+	void* memory_block_;
 
 };
 
@@ -49,6 +173,17 @@ class ComponentParticleSystem : public Component {
 public:
 	ComponentParticleSystem();
 
+	/// @brief Shapes of the volume where the particles spawn, in the system local space (Z is up).
+	enum SpawnShape {
+		kSpawnShape_Point = 0,
+		kSpawnShape_Box = 1,
+		kSpawnShape_Sphere = 2,
+		kSpawnShape_SphereShell = 3,
+		kSpawnShape_Cone = 4,
+		kSpawnShape_Disc = 5,
+		kSpawnShape_Line = 6,
+	};
+
 	/// @brief Initializes the particle system and its max particles.
 	void init(int max_particles);
 	/// @brief Add a texture to load it internally if it is not previously added to load and store its id.
@@ -56,9 +191,19 @@ public:
 
 
 	// -- These setters will be part of the modules, for now they are hard-coded --
-	/// @brief Spawn particles in a box area. If not called particles will spawn in the same position.
+	/// @brief Spawn particles in a box area. If no spawn area is set particles will spawn in the same position.
 	void setSpawnArea(float length, float width, float height);
-	/// @brief Time between two particles spawn.
+	/// @brief Spawn particles inside a sphere.
+	void setSpawnSphere(float radius);
+	/// @brief Spawn particles in the volume between two spheres, use the same radius to spawn them on the surface.
+	void setSpawnSphereShell(float inner_radius, float outer_radius);
+	/// @brief Spawn particles inside a cone with the apex in the origin that opens upwards.
+	void setSpawnCone(float angle_degrees, float height);
+	/// @brief Spawn particles in a horizontal disc.
+	void setSpawnDisc(float radius);
+	/// @brief Spawn particles along a segment.
+	void setSpawnLine(glm::vec3 start, glm::vec3 end);
+	/// @brief Time between two particles spawn. Rates shorter than the frame time spawn several particles per frame.
 	void setEmissionRate(float emission_rate);
 	/// @brief Time that a particle will live. If set to 0 it won't die.
 	void setLifetime(float lifetime);
@@ -66,38 +211,224 @@ public:
 	void setConstantVelocity(glm::vec3 constant_velocity);
 	/// @brief Set a random initial velocity between the two given vectors.
 	void setInitialVelocity(glm::vec3 min_velocity, glm::vec3 max_velocity);
-	/// @brief Interpolates initial velocity with final velocity over lifetime.
+	/// @brief Interpolates initial velocity with final velocity over lifetime, replacing the velocity of the particles.
+	///        Random initial velocities start from the middle of their range. Changing the initial velocity updates the curve.
 	void setVelocityOverTime(glm::vec3 final_velocity);
+	/// @brief Sets the velocity of the particles over their life time, linearly interpolated between the keys.
+	void setVelocityOverLifetime(const std::vector<ParticleVectorKey>& keys);
+	/// @brief Constant acceleration applied to all the particles.
+	void setGravity(glm::vec3 gravity);
+	/// @brief Directional wind, applied as a constant acceleration like the gravity.
+	void setWind(glm::vec3 wind);
+	/// @brief Drag that slows down the particles, proportional to their speed and to their squared speed.
+	void setDrag(float linear_drag, float quadratic_drag);
+	/// @brief Adds a point attractor in the system space, negative strength repels. A radius of 0 has no limit.
+	/// @return Index of the attractor.
+	int addAttractor(glm::vec3 position, float strength, float radius = 0.0f);
+	/// @brief Moves an existing attractor.
+	void setAttractorPosition(int index, glm::vec3 position);
+	/// @brief Removes all the attractors.
+	void clearAttractors();
+	/// @brief Moves the particles through curl noise, strength is the maximum speed it adds and frequency the noise features per unit.
+	///        Systems with the same seed share the noise. A strength of 0 disables it.
+	void setTurbulence(float strength, float frequency, uint32_t seed = 0);
+	/// @brief Loads a vector field file that moves the particles, placed in the system space by the bounds stored in the file
+	///        so the entity transform places it in the world. Fields are added to the velocity when moving the particles,
+	///        or accelerate them when used as a force. Throws if the file is not a valid vector field.
+	void setVectorField(const char* path, float strength, bool as_force = false);
+	/// @brief Stops using the vector field.
+	void clearVectorField();
+	/// @brief Adds a plane that keeps the particles on the side its normal points to.
+	/// @return Index of the collider.
+	int addCollisionPlane(glm::vec3 normal, float distance);
+	/// @brief Adds a sphere that keeps the particles out of it, or inside it if it is a container.
+	/// @return Index of the collider.
+	int addCollisionSphere(glm::vec3 center, float radius, bool container = false);
+	/// @brief Adds an axis aligned box that keeps the particles out of it.
+	/// @return Index of the collider.
+	int addCollisionBox(glm::vec3 box_min, glm::vec3 box_max);
+	/// @brief Removes all the colliders.
+	void clearColliders();
+	/// @brief Sets how particles react to the colliders. Bounce keeps that part of the normal velocity, friction removes
+	///        that part of the tangent velocity. Killed particles die when they touch a collider.
+	void setCollisionResponse(float bounce, float friction, bool kill = false);
+	/// @brief Particles closer than the radius interact with each other through the neighbour modules below.
+	void setNeighbourRadius(float radius);
+	/// @brief Pushes close particles apart, stronger the closer they are.
+	void setSeparation(float strength);
+	/// @brief Pulls the particles to the center of their neighbours.
+	void setCohesion(float strength);
+	/// @brief Steers the particles to the average velocity of their neighbours.
+	void setAlignment(float strength);
+	/// @brief Simple density based fluid, particles get pushed apart when their neighbourhood is denser than the rest density.
+	void setFluid(float stiffness, float rest_density);
+	/// @brief N-body gravity between all the particles, all of them with the same mass. 0 gravity disables it.
+	///        Softening keeps close particles from getting infinite accelerations.
+	///        Groups of particles seen under an angle smaller than opening_angle (radians) pull as a single mass,
+	///        bigger angles are faster and less accurate, 0 is the exact and O(n^2) sum.
+	void setSelfGravity(float gravity, float softening, float opening_angle = 0.5f);
+
+	/// @brief Events of the particles that can spawn particles in other systems.
+	enum ParticleEvent {
+		kParticleEvent_Birth = 0,
+		kParticleEvent_Death = 1,
+		kParticleEvent_Collision = 2,
+		kParticleEvent_Count = 3,
+	};
+	/// @brief Spawns particles_per_event particles in the target system every time a particle of this one raises the event.
+	///        They start at the particle position with the target initial velocity plus the particle velocity scaled by
+	///        inherit_velocity, both moved to the space of the target. The target keeps its own settings for everything else.
+	void addSubEmitter(ParticleEvent event, ComponentParticleSystem* target, int particles_per_event = 1,
+		float inherit_velocity = 0.0f);
+	void clearSubEmitters();
+	/// @brief Adds a level of detail used from the distance to the camera, the system keeps its full detail below the first one.
+	void addLODTier(float distance, float spawn_rate_scale, int max_alive_particles = 0, int update_interval = 1);
+	void clearLODTiers();
+	/// @brief Fraction of the tiers distance the camera has to move past it to change the tier, avoids popping at the threshold.
+	void setLODHysteresis(float hysteresis);
+	/// @brief Picks the tier for the distance from the camera to the system, called by the scene before simulating it.
+	void updateLOD(float camera_distance);
+	/// @return Current level of detail, 0 is full detail and N the tier N - 1.
+	int getLODLevel() { return lod_level_; }
+	/// @return Alpha between the last two steps of the system to draw it at, from the alpha between the last two updates of the scene.
+	///        Systems that skip updates are drawn one step behind, interpolating over the whole step as the skipped updates pass.
+	float getInterpolationAlpha(float update_alpha);
+	/// @brief Order the particles are drawn in.
+	enum SortMode {
+		kSortMode_None = 0,
+		/// @brief Farthest particles from the camera first, needed to blend them properly.
+		kSortMode_BackToFront = 1,
+		/// @brief Back to front starting from the order of the previous frame, cheaper for slow systems like smoke.
+		///        Falls back to the full sort when the particles moved too much between frames.
+		kSortMode_Incremental = 2,
+	};
+	void setSortMode(SortMode sort_mode);
+	/// @brief How the particles are stored in the pool.
+	enum PoolMode {
+		/// @brief Default pool, the alive particles are in [0, alive) and the last one takes the place of a dead one.
+		kPoolMode_Packed = 0,
+		/// @brief Circular buffer for emitters whose particles all live the same time, so they die in the order they spawned.
+		///        The alive particles are in up to two ranges that wrap around the arrays, see getAliveRanges.
+		///        Spawning appends at the head and dying advances the tail, the particles never move.
+		///        The system uses the packed pool while it has no max lifetime or uses the neighbour modules, the self gravity
+		///        or the collisions that kill particles, they don't let the particles die in the order they spawned.
+		kPoolMode_Ring = 1,
+	};
+	/// @brief The alive particles are moved to the new pool.
+	void setPoolMode(PoolMode pool_mode);
+	/// @brief Systems out of the camera view are simulated once every interval updates, 1 keeps simulating them every update.
+	void setOffscreenUpdateInterval(int interval);
+	/// @brief Spawns in the sub-emitters the particles of all the events recorded since the last call.
+	///        Called by the scene in a single pass once the simulation of every system has finished.
+	void spawnSubEmitters();
+	/// @brief Restarts the random sequence of the system, the same seed always generates the same simulation.
+	void setRandomSeed(uint32_t seed);
 	/// @brief If called it will spawn all the particles in the same frame.
 	void setBurst();
 	/// @brief Set a constant color for all the particles.
 	void setParticleColor(glm::vec4 color);
-	/// @brief Set a color to change the particle over their life time.
+	/// @brief Set a color to change the particle over their life time, starting from the particle color even if it changes later.
 	void setParticleColorOverTime(glm::vec4 final_color);
-	/// @brief Set an alpha value to change the particles over their life time.
+	/// @brief Set an alpha value to change the particles over their life time, starting from the particle alpha even if it changes later.
 	void setAlphaColorOverTime(float final_alpha);
+	/// @brief Sets a color gradient over the particles life time, linearly interpolated between the keys.
+	void setColorOverLifetime(const std::vector<ParticleColorKey>& keys);
+	/// @brief Sets the alpha of the particles over their life time, linearly interpolated between the keys.
+	void setAlphaOverLifetime(const std::vector<ParticleFloatKey>& keys);
 
 
 	int getMaxParticles() { return max_particles_; }
 	/// @return Current used texture id.
 	int getTextureID() { return texture_id_; }
 
-	std::vector<Particle*>& getAliveParticles();
-	std::vector<Particle*>& getAllParticles();
+	/// @return Current number of alive particles.
+	int getAliveParticles() { return alive_particles_; }
+	/// @return Particles data arrays, only the particles in the alive ranges are alive.
+	const ParticleData& getParticleData() { return particles_; }
+	/// @return Index in the particle arrays of the n-th alive particle, the oldest one is the first in the ring pool.
+	int getAliveIndex(int n) {
+		if (!ring_layout_) return n;
+		int index = ring_tail_ + n;
+		return index < max_particles_ ? index : index - max_particles_;
+	}
+	/// @brief Ranges [begin, end) of the particle arrays that hold the alive particles, oldest first.
+	/// @return Number of ranges, one in the packed pool and up to two in the ring pool.
+	int getAliveRanges(int begin[2], int end[2]);
+
+	/// @brief Size of the quads the particles are drawn with.
+	static constexpr float kParticleDrawSize = 0.2f;
+	/// @return Box around the alive particles and the emitter origin in the system local space, refreshed by every update.
+	glm::vec3 getBoundsMin() { return bounds_min_; }
+	glm::vec3 getBoundsMax() { return bounds_max_; }
+	/// @return Sphere around the bounds box.
+	glm::vec3 getBoundingSphereCenter() { return (bounds_min_ + bounds_max_) * 0.5f; }
+	float getBoundingSphereRadius() { return glm::length(bounds_max_ - bounds_min_) * 0.5f; }
+	/// @return Indices of the alive particles in the order they are drawn, nullptr when they are drawn in pool order.
+	const uint32_t* getDrawOrder() {
+		return draw_order_.size() == static_cast<size_t>(alive_particles_) && alive_particles_ > 0 ? draw_order_.data() : nullptr;
+	}
+	/// @return True if the system was out of the camera view in the last scene update, culled systems are not drawn.
+	bool isCulled() { return culled_; }
 
 protected:
 	~ComponentParticleSystem();
 
+	/// @brief Counts an update of the scene and returns if the system is simulated in it, with the time since its last step.
+	bool advanceLODStep(double deltatime, double* step);
+	/// @brief Picks the update kernel specialized for the enabled modules, called whenever they change.
+	void selectUpdateKernel();
 	/// @brief Emit stage where particles get spawned and initialized.
 	void emit(double deltatime);
+	/// @brief Generates the spawn positions of the particles in [first, first + count) in a single pass over the arrays.
+	void spawnPositions(int first, int count);
 	/// @brief Particles update and die if they surpass their lifetime.
 	void update(double deltatime);
 	/// @brief Particles get sorted by their distance to the camera if the blending mode requires it.
 	void sort();
-
-
-	std::vector<Particle*> particles_;
+	/// @brief Fixes the order of the previous sort with an insertion pass, the new particles and the ones that moved far are merged into it.
+	/// @return False if the order changed too much and the particles need a full sort.
+	bool sortIncremental();
+
+	/// @brief Alive particles from which the update is split in chunks of this size that run in parallel.
+	static const int kUpdateChunkSize = 16384;
+	/// @brief Updates the particles in parallel chunks, each chunk removes its dead particles and the alive ones are packed again after.
+	void updateChunks(const ParticleUpdateParams& params, JobSystem* job_system);
+	/// @brief Applies the neighbour modules, the particles are hashed in a grid with cells of the neighbour radius.
+	void updateNeighbours(float delta_time, JobSystem* job_system);
+	/// @brief Gives the particles their initial color, life time and velocity, positions are set by the caller.
+	void initParticles(int first, int count);
+	/// @brief Max alive particles of the current level of detail.
+	int getMaxAliveParticles();
+	/// @brief Spawns the particles of the events, per_event particles at each one of them.
+	///        The events are moved from the space of the system that raised them with source_to_system.
+	void emitAt(const ParticleEventRecord* events, int count, int per_event, float inherit_velocity,
+		const glm::mat4& source_to_system);
+	/// @brief Runs the collision kernel over [begin, end), recording the collision events if something listens to them.
+	int collideParticles(const ParticleUpdateParams& params, int begin, int end);
+	/// @brief Box around the particles in [begin, end), grown by the draw size so it contains the whole quads.
+	void computeBounds(int begin, int end, glm::vec3* bounds_min, glm::vec3* bounds_max);
+	/// @brief Removes the dead particles of [begin, end) packing the alive ones at its beginning.
+	/// @return Number of alive particles in the range.
+	int compactParticles(int begin, int end);
+	/// @brief Ranges [begin, end) of the particle arrays where the next count particles spawn, right after the alive ones.
+	/// @return Number of ranges, the ring pool wraps to the beginning of the arrays.
+	int getSpawnRanges(int count, int begin[2], int end[2]);
+	/// @brief Updates the ring pool, the particles that reached the max lifetime are the oldest ones at its tail.
+	void updateRing(const ParticleUpdateParams& params, JobSystem* job_system);
+	/// @return If the particles die in the order they spawned with the current modules, as the ring pool needs.
+	bool isRingPoolSupported();
+	/// @brief Moves the particles to the ring or to the packed pool, called by the setters that change which one is used.
+	void updatePoolLayout();
+
+
+	/// @brief Alive particles are packed in [0, alive_particles_) in the packed pool, dead ones are after them.
+	///        The ring pool keeps them in [ring_tail_, ring_tail_ + alive_particles_) wrapping around the arrays.
+	ParticleData particles_;
 	int alive_particles_;
+	PoolMode pool_mode_;
+	/// @brief Particles stored in the ring, only in the ring pool mode and while its modules support it.
+	bool ring_layout_;
+	int ring_tail_;
 	int max_particles_;
 	float max_life_time_;
 
@@ -110,16 +441,119 @@ protected:
 	/// @brief Max velocity for the random distribution.
 	glm::vec3 max_velocity_;
 
+	/// @brief Samples of the over lifetime curves baked in the lookup tables.
+	static const int kCurveSamples = 256;
+
 	/// @brief Indicates if the color should interpolate over time.
 	bool lerp_color_;
 	/// @brief Indicates if the alpha value should interpolate over time.
 	bool lerp_alpha_;
-	/// @brief Color to lerp.
-	glm::vec4 final_color_;
 	/// @brief Indicates if the speed should interpolate over time.
 	bool lerp_speed_;
-	/// @brief Speed to lerp.
-	glm::vec3 final_speed_;
+	/// @brief Over lifetime curves baked per channel, sampled by the normalized age.
+	float color_curve_[4][kCurveSamples];
+	float alpha_curve_[kCurveSamples];
+	float velocity_curve_[3][kCurveSamples];
+	/// @brief End values of the over time presets, their curves are baked again when the initial color or velocity changes.
+	bool color_over_time_;
+	bool alpha_over_time_;
+	bool velocity_over_time_;
+	glm::vec4 final_color_;
+	float final_alpha_;
+	glm::vec3 final_velocity_;
+
+	/// @brief Forces module, velocities over lifetime override the velocity accumulated from them.
+	glm::vec3 gravity_;
+	glm::vec3 wind_;
+	float linear_drag_;
+	float quadratic_drag_;
+	std::vector<ParticleAttractor> attractors_;
+
+	/// @brief Turbulence module, the noise field is shared and owned by the noise cache.
+	const VectorField* turbulence_field_;
+	float turbulence_strength_;
+	float turbulence_frequency_;
+
+	/// @brief Vector field module, the field is shared and owned by the assets cache.
+	const VectorField* vector_field_;
+	float vector_field_strength_;
+	bool vector_field_force_;
+
+	/// @brief Collision module, tested after moving the particles.
+	std::vector<ParticleCollider> colliders_;
+	float collision_bounce_;
+	float collision_friction_;
+	bool collision_kill_;
+	int (*collision_kernel_)(ParticleData& particles, int begin, int end, const ParticleUpdateParams& params);
+
+	/// @brief Neighbour modules, they are disabled while all their strengths are 0.
+	float neighbour_radius_;
+	float separation_strength_;
+	float cohesion_strength_;
+	float alignment_strength_;
+	float fluid_stiffness_;
+	float fluid_rest_density_;
+	/// @brief Grid rebuilt every update to find the neighbours, created the first time it's needed.
+	SpatialHashGrid* neighbour_grid_;
+	/// @brief Acceleration from the neighbours and density of every particle.
+	std::vector<float> neighbour_scratch_;
+
+	/// @brief Self gravity, evaluated with a Barnes-Hut octree rebuilt every update.
+	float self_gravity_;
+	float self_gravity_softening_;
+	float self_gravity_opening_angle_;
+	BarnesHutOctree* gravity_octree_;
+
+	/// @brief Systems that spawn particles when the particles of this one raise an event.
+	struct SubEmitter {
+		ParticleEvent event;
+		ComponentParticleSystem* target;
+		int particles_per_event;
+		float inherit_velocity;
+	};
+	std::vector<SubEmitter> sub_emitters_;
+	/// @brief Events recorded by the simulation threads, only created for the events a sub-emitter listens to.
+	ParticleEventQueue* event_queues_[kParticleEvent_Count];
+	/// @brief Events of all the threads gathered when spawning the sub-emitters.
+	std::vector<ParticleEventRecord> pending_events_[kParticleEvent_Count];
+	/// @brief Particles that touched a collider in the last update, filled only when the collision events are recorded.
+	std::vector<unsigned char> collision_flags_;
+
+	/// @brief Level of detail tiers sorted by distance, the current one and the updates counted towards its interval.
+	std::vector<ParticleLODTier> lod_tiers_;
+	float lod_hysteresis_;
+	int lod_level_;
+	/// @brief Spreads the steps of the systems with the same interval over different updates.
+	int lod_phase_;
+	int lod_update_count_;
+	double lod_skipped_time_;
+	/// @brief Time of the last update of the scene and of the last step of the system, which may cover several updates.
+	double lod_update_time_;
+	double lod_step_time_;
+
+	/// @brief Draw order of the alive particles and the sorter that builds it.
+	SortMode sort_mode_;
+	std::vector<uint32_t> draw_order_;
+	RadixSorter* sorter_;
+	/// @brief Previous order rebuilt from the particle ranks and the particles sorted apart, used by the incremental sort.
+	///        Entries pack the key bits over the particle index so they compare as integers.
+	std::vector<uint64_t> sort_entries_;
+	std::vector<uint64_t> sort_merged_;
+	/// @brief Keys of the ring pool gathered in a single array when it wraps around, the radix sort needs them contiguous.
+	std::vector<float> ring_sort_keys_;
+	/// @brief Sorts left before trying the incremental sort again, after it found an order that changed too much.
+	int incremental_sort_delay_;
+	/// @brief Transform from the system space to offsets from the camera in world space, set by the scene before sorting.
+	glm::mat4 sort_to_camera_;
+	/// @brief Model matrix of the entity, set by the scene every update so the events reach the sub-emitters in their space.
+	glm::mat4 model_;
+
+	/// @brief Bounds of the last update, the bounds of every chunk of the parallel update and the culling result.
+	glm::vec3 bounds_min_;
+	glm::vec3 bounds_max_;
+	std::vector<glm::vec3> chunk_bounds_;
+	bool culled_;
+	int offscreen_update_interval_;
 
 	/// @brief Time that passes between two particles spawning.
 	float emission_rate_;
@@ -135,8 +569,33 @@ protected:
 	/// @brief Internal ID of the texture used in the particle system.
 	int texture_id_;
 
-	/// @brief Time passed since last spawned particle
-	float last_time_;
+	/// @brief Time left to spawn the next particle, negative when several particles are pending.
+	double next_spawn_time_;
+
+	/// @brief Shape of the volume where particles spawn.
+	SpawnShape spawn_shape_;
+	/// @brief Size of the spawn box.
+	glm::vec3 spawn_box_size_;
+	/// @brief Outer radius of the spheres and disc, inner radius of the sphere shell.
+	float spawn_radius_;
+	float spawn_inner_radius_;
+	/// @brief Half angle and height of the spawn cone.
+	float spawn_cone_angle_;
+	float spawn_cone_height_;
+	/// @brief Segment used by the line spawn shape.
+	glm::vec3 spawn_line_start_;
+	glm::vec3 spawn_line_end_;
+	/// @brief Scratch random numbers used while generating the spawn positions.
+	std::vector<float> spawn_scratch_;
+
+	/// @brief Random generator of the system, owned by it so systems can be simulated in parallel.
+	RandomGenerator random_;
+
+	/// @brief Alive particles of each chunk after a parallel update.
+	std::vector<int> chunk_alive_particles_;
+
+	/// @brief Update kernel selected at runtime for the best instruction set of the CPU (Scalar, SSE or AVX2).
+	int (*update_kernel_)(ParticleData& particles, int begin, int end, const ParticleUpdateParams& params);
 
 	friend class Scene;
 
@@ -26,6 +26,13 @@ public:
 
 	glm::mat4 getViewMatrix();
 	glm::mat4 getProjectionMatrix();
+	/// @return Position of the camera in world space.
+	glm::vec3 getPosition();
+
+	/// @return False if the sphere, in world space, is completely out of the view frustum.
+	bool isSphereVisible(glm::vec3 center, float radius);
+	/// @return False if the box, given in the space the model matrix transforms to world space, is completely out of the view frustum.
+	bool isBoxVisible(glm::vec3 box_min, glm::vec3 box_max, const glm::mat4& model);
 
 	/// @brief Uses the wheel offset to zoom out/in
 	void zoom(float wheeel_offset);
@@ -36,6 +43,8 @@ public:
 
 private:
 	void updateViewMatrix();
+	/// @brief Extracts the frustum planes from the view projection matrix, called whenever any of them changes.
+	void updateFrustumPlanes();
 
 	glm::vec3 position_;
 	glm::vec3 rotation_;
@@ -43,6 +52,8 @@ private:
 
 	glm::mat4 view_;
 	glm::mat4 projection_;
+	/// @brief Left, right, bottom, top, near and far planes in world space, normals point inside the frustum.
+	glm::vec4 frustum_planes_[6];
 
 	glm::vec2 last_mouse_pos_;
 	bool is_moving_;
@@ -42,11 +42,4 @@ const bool ENABLE_MSAA = true;
 
 // ------------------------------------------------------------------------- // 
 
-/// @brief returns a random float number between min and max provided values.
-static float randFloat(float min, float max) {
-	return min + static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / (max - min)));
-}
-
-// ------------------------------------------------------------------------- // 
-
 #endif //__COMMON_DEF_H__
\ No newline at end of file
@@ -0,0 +1,87 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+#ifndef __JOB_SYSTEM_H__
+#define __JOB_SYSTEM_H__
+
+// ------------------------------------------------------------------------- //
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+// ------------------------------------------------------------------------- //
+
+/**
+* @brief Runs jobs on a pool of worker threads sized to the hardware threads.
+*        Each thread owns a deque, pushes and pops its own jobs from the back and
+*        steals from the front of the others when it runs out of work.
+*/
+class JobSystem {
+public:
+	JobSystem();
+	~JobSystem();
+
+	typedef std::function<void()> Job;
+
+	/// @brief Counts the pending jobs of a group so they can be joined.
+	struct JobCounter {
+		JobCounter() : pending_(0) {}
+		std::atomic<int> pending_;
+	};
+
+	/// @brief Starts the workers, the calling thread is used as thread 0. With 0 workers it uses one per extra hardware thread.
+	void init(int worker_threads = 0);
+	/// @brief Finishes the queued jobs and joins the workers.
+	void shutDown();
+
+	/// @brief Queues a job in the deque of the calling thread, the counter is decremented when it finishes.
+	void run(Job job, JobCounter* counter);
+	/// @brief Waits until all the jobs of the counter finish, executing queued jobs meanwhile.
+	void wait(JobCounter* counter);
+	/// @brief Splits [0, count) in chunks of chunk_size and runs them in parallel, returns when all of them finish.
+	void parallelFor(int count, int chunk_size, const std::function<void(int begin, int end)>& job);
+
+	/// @return Number of threads that execute jobs, including the one that initialized the system.
+	int getThreadCount() { return static_cast<int>(queues_.size()); }
+	/// @return Index of the calling thread in [0, getThreadCount()), 0 for threads outside the system.
+	static int getThreadIndex();
+
+private:
+	struct QueuedJob {
+		Job job_;
+		JobCounter* counter_;
+	};
+
+	/// @brief Deque of jobs owned by a thread, other threads steal from its front.
+	struct WorkerQueue {
+		std::mutex mutex_;
+		std::deque<QueuedJob> jobs_;
+	};
+
+	/// @brief Loop executed by the worker threads until shut down.
+	void workerLoop(int thread_index);
+	/// @brief Pops a job from the own deque or steals one from another thread.
+	bool findJob(int thread_index, QueuedJob& queued_job);
+	/// @brief Executes a job and notifies its counter.
+	void execute(QueuedJob& queued_job);
+
+	std::vector<WorkerQueue*> queues_;
+	std::vector<std::thread> workers_;
+
+	/// @brief Jobs queued but not taken yet, used to put the workers to sleep.
+	std::atomic<int> queued_jobs_;
+	std::atomic<bool> running_;
+	std::mutex sleep_mutex_;
+	std::condition_variable wake_condition_;
+
+};
+
+// ------------------------------------------------------------------------- //
+
+#endif // __JOB_SYSTEM_H__
@@ -0,0 +1,60 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+#ifndef __RANDOM_H__
+#define __RANDOM_H__
+
+// ------------------------------------------------------------------------- //
+
+#include <cstdint>
+#include <glm.hpp>
+
+// ------------------------------------------------------------------------- //
+
+/**
+* @brief Seeded random generator based on xoshiro128+.
+*        It runs four independent streams side by side, so the batch functions
+*        generate four numbers per iteration and the compiler can vectorize them.
+*        The same seed always generates the same integers and floats in every platform. The unit vectors
+*        and the spawn shapes built from them go through the sine, cosine and cube root of the C library,
+*        whose last bits may differ between platforms, so they only repeat exactly in the same one.
+*/
+class RandomGenerator {
+public:
+	explicit RandomGenerator(uint32_t seed = 0);
+
+	/// @brief Restarts the sequence from a seed.
+	void setSeed(uint32_t seed);
+
+	/// @return Random number in [0, 2^32).
+	uint32_t nextUInt();
+	/// @return Random number in [0, 1).
+	float nextFloat();
+	/// @return Random number in [min, max).
+	float nextFloat(float min, float max);
+
+	/// @brief Fills an array with random numbers in [min, max).
+	void fillFloats(float* dst, int count, float min, float max);
+	/// @brief Fills three arrays (SoA) with random vectors, each component in [min, max).
+	void fillVec3(float* dst_x, float* dst_y, float* dst_z, int count, glm::vec3 min, glm::vec3 max);
+	/// @brief Fills three arrays (SoA) with random directions uniformly distributed in the unit sphere surface.
+	void fillUnitVectors(float* dst_x, float* dst_y, float* dst_z, int count);
+
+private:
+	static const int kStreams = 4;
+
+	/// @brief Advances the four streams and writes the number generated by each one.
+	void nextUInts(uint32_t* dst);
+
+	/// @brief State of each stream, stored as [state word][stream] to keep the streams contiguous.
+	uint32_t state_[4][kStreams];
+	/// @brief Numbers generated but not returned yet by nextUInt.
+	uint32_t buffered_[kStreams];
+	int buffered_count_;
+
+};
+
+// ------------------------------------------------------------------------- //
+
+#endif // __RANDOM_H__
@@ -12,6 +12,7 @@
 #include "engine/input.h"
 #include "engine/camera.h"
 #include "engine/scene.h"
+#include "engine/job_system.h"
 
 // ------------------------------------------------------------------------- //
 
@@ -54,6 +55,8 @@ public:
   void loadScene(Scene* scene);
   /// @brief This method has to be called to start the editor after setting a scene.
   void run();
+  /// @brief Time simulated in each update step and the max steps done in a rendered frame.
+  void setFixedTimeStep(double time_step, int max_steps_per_frame);
 
 
 
@@ -61,6 +64,10 @@ public:
 	Camera* getCamera();
   /// @return Current scene running.
 	Scene* getScene();
+  /// @return Job system used to run the simulation in parallel.
+  JobSystem* getJobSystem();
+  /// @return Fraction of a step between the last two simulated states that is being rendered.
+  float getInterpolationAlpha();
 
 private:
   ParticleEditor();
@@ -82,6 +89,15 @@ private:
   Camera* camera_;
   /// @brief The scene which is loaded to run on the editor.
   Scene* active_scene_;
+  /// @brief Worker threads that run the particle systems simulation.
+  JobSystem* job_system_;
+
+  /// @brief Time simulated in each update, decoupled from the render frame rate.
+  double fixed_time_step_;
+  /// @brief Max updates done in a frame, it prevents long hitches to stall the next frames.
+  int max_steps_per_frame_;
+  /// @brief Fraction of the step that the rendered frame is ahead the last simulated state.
+  float interpolation_alpha_;
 
   /// @brief Internal data and functions to manage internal APIs resources hiding them from the user.
   struct AppData;
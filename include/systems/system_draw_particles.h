@@ -15,9 +15,10 @@
 #include <glm.hpp>
 
 #include "system.h"
+#include "system_sort.h"
 #include "particle_editor.h"
 
-struct Particle;
+struct ParticleData;
 
 // ------------------------------------------------------------------------- //
 
@@ -38,11 +39,17 @@ public:
 	void updateUniformBuffers(int current_image, std::vector<Entity*>& entities);
 
 protected:
-	/// @return Model matrix for all the particles.
-	glm::mat4* getParticlesModelMatrices(std::vector<Entity*>& entities);
+	/// @return Number of alive particles of the particle systems not culled, the ones that are uploaded and drawn.
+	int getAliveParticles(std::vector<Entity*>& entities);
 
-	/// @return Particle materials data for all the particles (Shader uniforms).
-	glm::mat4* getParticleMaterialsData(std::vector<Entity*>& entities);
+	/// @return Model matrix for all the particles, in the global order of the sort system.
+	glm::mat4* getParticlesModelMatrices(SystemSort* system_sort);
+
+	/// @return Particle materials data for all the particles (Shader uniforms), in the global order of the sort system.
+	glm::mat4* getParticleMaterialsData(SystemSort* system_sort);
+
+	/// @brief Interpolation alpha of each system of the sort system.
+	std::vector<float> system_alphas_;
 
 };
 
@@ -0,0 +1,71 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+#ifndef __SYSTEM_SORT_H__
+#define __SYSTEM_SORT_H__
+
+// ------------------------------------------------------------------------- //
+
+#include <vector>
+#include <cstdint>
+
+#include "systems/system.h"
+
+class ComponentParticleSystem;
+class ComponentTransform;
+
+// ------------------------------------------------------------------------- //
+
+/**
+* @brief This system acts on each entity with a particle system archetype.
+*        It merges the particles of all the systems in a single back to front order, so overlapping systems blend properly.
+*        Every system sorts its own particles in parallel, this system only merges their sorted runs.
+*/
+class SystemSort : public System {
+public:
+	SystemSort();
+	~SystemSort();
+
+	/// @brief Particle of the global order, system is the index in the sorted systems.
+	struct SortedParticle {
+		uint32_t system;
+		uint32_t particle;
+	};
+
+	/// @brief Builds the global order of the particles of the systems not culled, called after the systems sorted their particles.
+	///        Systems without their own order are drawn first in pool order.
+	void sortParticles(std::vector<Entity*>& entities);
+
+	/// @return Particles of all the systems in the order they are drawn.
+	const std::vector<SortedParticle>& getDrawOrder() { return draw_order_; }
+	/// @return Particle system of each system index of the order.
+	const std::vector<ComponentParticleSystem*>& getSortedSystems() { return systems_; }
+	/// @return Transform of each system index of the order.
+	const std::vector<ComponentTransform*>& getSortedTransforms() { return transforms_; }
+
+protected:
+	/// @brief Next particle of the sorted run of a system, the heap keeps the farthest one on top.
+	struct RunHead {
+		float key;
+		uint32_t system;
+		/// @brief Position of the particle in the run keys.
+		int next;
+	};
+
+	/// @brief Moves the head down the heap until its children are nearer.
+	void siftDown(int head);
+
+	std::vector<ComponentParticleSystem*> systems_;
+	std::vector<ComponentTransform*> transforms_;
+	std::vector<SortedParticle> draw_order_;
+	std::vector<RunHead> heap_;
+	/// @brief Keys of every sorted system in its draw order, read linearly by the merge, and where the run of each system starts.
+	std::vector<float> run_keys_;
+	std::vector<int> run_begin_;
+
+};
+
+// ------------------------------------------------------------------------- //
+
+#endif // __SYSTEM_SORT_H__
@@ -8,18 +8,201 @@
 
 #include "components/component_particle_system.h"
 #include "../src/engine_internal/internal_app_data.h"
+#include "../src/engine_internal/internal_particle_kernels.h"
+#include "../src/engine_internal/internal_spatial_grid.h"
+#include "../src/engine_internal/internal_octree.h"
+#include "../src/engine_internal/internal_particle_events.h"
+#include "../src/engine_internal/internal_radix_sort.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cstring>
 
  // ------------------------------------------------------------------------- //
 
+// Bakes a channel of the curve keys into the lookup table, linearly interpolating between them
+// Before the first key and after the last one the curve keeps their values
+template <class Key, class Channel>
+static void bakeCurve(std::vector<Key> keys, float* curve, int samples, Channel channel) {
+
+	std::stable_sort(keys.begin(), keys.end(),
+		[](const Key& a, const Key& b) { return a.time < b.time; });
+
+	int next_key = 0;
+	for (int i = 0; i < samples; ++i) {
+		float age = i / static_cast<float>(samples - 1);
+		while (next_key < keys.size() && keys[next_key].time <= age) ++next_key;
+
+		if (next_key == 0) {
+			curve[i] = channel(keys.front());
+		}
+		else if (next_key == keys.size()) {
+			curve[i] = channel(keys.back());
+		}
+		else {
+			const Key& previous = keys[next_key - 1];
+			const Key& next = keys[next_key];
+			float t = (age - previous.time) / (next.time - previous.time);
+			curve[i] = channel(previous) + (channel(next) - channel(previous)) * t;
+		}
+	}
+
+}
+
+// ------------------------------------------------------------------------- //
+
+ParticleData::ParticleData() {
+
+	memory_block_ = nullptr;
+	release();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+ParticleData::~ParticleData() {
+
+	release();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ParticleData::allocate(int max_particles) {
+
+	release();
+
+	// Each array starts in its own cache line
+	const size_t alignment = 64;
+	size_t float_array_size = (max_particles * sizeof(float) + alignment - 1) & ~(alignment - 1);
+	const int float_arrays = 15;
+
+	// Ranks are the size of a float, the last array of the block
+	size_t block_size = float_array_size * (float_arrays + 1);
+	if (block_size == 0) block_size = alignment;
+
+	memory_block_ = alignedAlloc(block_size, alignment);
+	if (memory_block_ == nullptr) {
+		throw std::runtime_error("\nFailed to allocate particles data.");
+	}
+	capacity_ = max_particles;
+
+	uint8_t* cursor = static_cast<uint8_t*>(memory_block_);
+	float** float_arrays_ptr[float_arrays] = {
+		&position_x_, &position_y_, &position_z_,
+		&previous_position_x_, &previous_position_y_, &previous_position_z_,
+		&velocity_x_, &velocity_y_, &velocity_z_,
+		&color_r_, &color_g_, &color_b_, &color_a_,
+		&life_time_, &sort_key_,
+	};
+	for (int i = 0; i < float_arrays; ++i) {
+		*float_arrays_ptr[i] = reinterpret_cast<float*>(cursor);
+		cursor += float_array_size;
+	}
+	sort_rank_ = reinterpret_cast<uint32_t*>(cursor);
+
+	// Dead particles are placed out of the view
+	for (int i = 0; i < capacity_; ++i) {
+		setPosition(i, glm::vec3(0.0f, 0.0f, -10000.0f));
+		setVelocity(i, glm::vec3(0.0f, 0.0f, 0.0f));
+		setColor(i, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+		life_time_[i] = 0.0f;
+		sort_key_[i] = 0.0f;
+		sort_rank_[i] = kUnsorted;
+	}
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ParticleData::copy(int dst_index, int src_index) {
+
+	position_x_[dst_index] = position_x_[src_index];
+	position_y_[dst_index] = position_y_[src_index];
+	position_z_[dst_index] = position_z_[src_index];
+	previous_position_x_[dst_index] = previous_position_x_[src_index];
+	previous_position_y_[dst_index] = previous_position_y_[src_index];
+	previous_position_z_[dst_index] = previous_position_z_[src_index];
+	velocity_x_[dst_index] = velocity_x_[src_index];
+	velocity_y_[dst_index] = velocity_y_[src_index];
+	velocity_z_[dst_index] = velocity_z_[src_index];
+	color_r_[dst_index] = color_r_[src_index];
+	color_g_[dst_index] = color_g_[src_index];
+	color_b_[dst_index] = color_b_[src_index];
+	color_a_[dst_index] = color_a_[src_index];
+	life_time_[dst_index] = life_time_[src_index];
+	sort_key_[dst_index] = sort_key_[src_index];
+	sort_rank_[dst_index] = sort_rank_[src_index];
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ParticleData::swap(int index_a, int index_b) {
+
+	std::swap(position_x_[index_a], position_x_[index_b]);
+	std::swap(position_y_[index_a], position_y_[index_b]);
+	std::swap(position_z_[index_a], position_z_[index_b]);
+	std::swap(previous_position_x_[index_a], previous_position_x_[index_b]);
+	std::swap(previous_position_y_[index_a], previous_position_y_[index_b]);
+	std::swap(previous_position_z_[index_a], previous_position_z_[index_b]);
+	std::swap(velocity_x_[index_a], velocity_x_[index_b]);
+	std::swap(velocity_y_[index_a], velocity_y_[index_b]);
+	std::swap(velocity_z_[index_a], velocity_z_[index_b]);
+	std::swap(color_r_[index_a], color_r_[index_b]);
+	std::swap(color_g_[index_a], color_g_[index_b]);
+	std::swap(color_b_[index_a], color_b_[index_b]);
+	std::swap(color_a_[index_a], color_a_[index_b]);
+	std::swap(life_time_[index_a], life_time_[index_b]);
+	std::swap(sort_key_[index_a], sort_key_[index_b]);
+	std::swap(sort_rank_[index_a], sort_rank_[index_b]);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ParticleData::release() {
+
+	if (memory_block_ != nullptr) {
+		alignedFree(memory_block_);
+	}
+
+	position_x_ = nullptr;
+	position_y_ = nullptr;
+	position_z_ = nullptr;
+	previous_position_x_ = nullptr;
+	previous_position_y_ = nullptr;
+	previous_position_z_ = nullptr;
+	velocity_x_ = nullptr;
+	velocity_y_ = nullptr;
+	velocity_z_ = nullptr;
+	color_r_ = nullptr;
+	color_g_ = nullptr;
+	color_b_ = nullptr;
+	color_a_ = nullptr;
+	life_time_ = nullptr;
+	sort_key_ = nullptr;
+	sort_rank_ = nullptr;
+
+	capacity_ = 0;
+	memory_block_ = nullptr;
+
+}
+
+// ------------------------------------------------------------------------- //
+
 ComponentParticleSystem::ComponentParticleSystem() : Component(Component::kComponentKind_ParticleSystem) {
 
-	particles_ = std::vector<Particle*>();
 	initial_color_ = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
 	initial_velocity_ = glm::vec3(0.0f, 0.0f, 0.1f);
 	min_velocity_ = glm::vec3(-0.1f, -0.1f, 0.1f);
 	max_velocity_ = glm::vec3(0.1f, 0.1f, 0.12f);
 	max_particles_ = 0;
 	alive_particles_ = 0;
+	pool_mode_ = kPoolMode_Packed;
+	ring_layout_ = false;
+	ring_tail_ = 0;
 	max_life_time_ = 5.0f;
 	emission_rate_ = 0.2f;
 	burst_ = false;
@@ -29,13 +212,87 @@ ComponentParticleSystem::ComponentParticleSystem() : Component(Component::kCompo
 	material_parent_id_ = 2;
 	texture_id_ = -1;
 
-	last_time_ = 0.0f;
+	next_spawn_time_ = 0.0;
+
+	spawn_shape_ = kSpawnShape_Point;
+	spawn_box_size_ = glm::vec3(0.0f, 0.0f, 0.0f);
+	spawn_radius_ = 0.0f;
+	spawn_inner_radius_ = 0.0f;
+	spawn_cone_angle_ = 0.0f;
+	spawn_cone_height_ = 0.0f;
+	spawn_line_start_ = glm::vec3(0.0f, 0.0f, 0.0f);
+	spawn_line_end_ = glm::vec3(0.0f, 0.0f, 0.0f);
+
+	// Each system gets a different seed, repeated in every run for reproducible simulations
+	static uint32_t next_seed = 0;
+	random_.setSeed(next_seed++);
+
+	lod_hysteresis_ = 0.1f;
+	lod_level_ = 0;
+	static int next_lod_phase = 0;
+	lod_phase_ = next_lod_phase++;
+	lod_update_count_ = 0;
+	lod_skipped_time_ = 0.0;
+	lod_update_time_ = 0.0;
+	lod_step_time_ = 0.0;
+
+	bounds_min_ = glm::vec3(0.0f);
+	bounds_max_ = glm::vec3(0.0f);
+	culled_ = false;
+	offscreen_update_interval_ = 1;
+
+	sort_mode_ = kSortMode_BackToFront;
+	sorter_ = nullptr;
+	incremental_sort_delay_ = 0;
+	sort_to_camera_ = glm::mat4(1.0f);
+	model_ = glm::mat4(1.0f);
 
 	lerp_color_ = false;
 	lerp_alpha_ = false;
-	final_color_ = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
 	lerp_speed_ = false;
-	final_speed_ = glm::vec3(0.0f, 0.0f, 0.1f);
+	color_over_time_ = false;
+	alpha_over_time_ = false;
+	velocity_over_time_ = false;
+	final_color_ = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	final_alpha_ = 1.0f;
+	final_velocity_ = glm::vec3(0.0f, 0.0f, 0.0f);
+
+	gravity_ = glm::vec3(0.0f, 0.0f, 0.0f);
+	wind_ = glm::vec3(0.0f, 0.0f, 0.0f);
+	linear_drag_ = 0.0f;
+	quadratic_drag_ = 0.0f;
+
+	turbulence_field_ = nullptr;
+	turbulence_strength_ = 0.0f;
+	turbulence_frequency_ = 1.0f;
+
+	vector_field_ = nullptr;
+	vector_field_strength_ = 0.0f;
+	vector_field_force_ = false;
+
+	collision_bounce_ = 0.5f;
+	collision_friction_ = 0.1f;
+	collision_kill_ = false;
+	collision_kernel_ = getParticleCollisionKernel(getParticleInstructionSet());
+
+	neighbour_radius_ = 0.0f;
+	separation_strength_ = 0.0f;
+	cohesion_strength_ = 0.0f;
+	alignment_strength_ = 0.0f;
+	fluid_stiffness_ = 0.0f;
+	fluid_rest_density_ = 0.0f;
+	neighbour_grid_ = nullptr;
+
+	self_gravity_ = 0.0f;
+	self_gravity_softening_ = 0.0f;
+	self_gravity_opening_angle_ = 0.5f;
+	gravity_octree_ = nullptr;
+
+	for (int e = 0; e < kParticleEvent_Count; ++e) {
+		event_queues_[e] = nullptr;
+	}
+
+	selectUpdateKernel();
 
 }
 
@@ -43,10 +300,13 @@ ComponentParticleSystem::ComponentParticleSystem() : Component(Component::kCompo
 
 ComponentParticleSystem::~ComponentParticleSystem() {
 
-	for (int i = 0; i < max_particles_; ++i) {
-		delete particles_[i];
+	particles_.release();
+	delete neighbour_grid_;
+	delete gravity_octree_;
+	delete sorter_;
+	for (int e = 0; e < kParticleEvent_Count; ++e) {
+		delete event_queues_[e];
 	}
-	particles_.clear();
 
 }
 
@@ -60,10 +320,12 @@ void ComponentParticleSystem::init(int max_particles) {
 	burst_ = false;
 
 	alive_particles_ = 0;
+	ring_tail_ = 0;
+	updatePoolLayout();
 
-	particles_ = std::vector<Particle*>(max_particles_);
+	particles_.allocate(max_particles_);
 	for (int i = 0; i < max_particles_; ++i) {
-		particles_[i] = new Particle();
+		particles_.setColor(i, initial_color_);
 	}
 
 }
@@ -72,239 +334,1510 @@ void ComponentParticleSystem::init(int max_particles) {
 
 void ComponentParticleSystem::emit(double deltatime) {
 
-	if (alive_particles_ == max_particles_) return;
+	// Every simulation thread records its events in its own buffer, in a batch after the events of the last step
+	JobSystem* job_system = ParticleEditor::instance().getJobSystem();
+	int thread_count = job_system != nullptr ? job_system->getThreadCount() : 1;
+	for (int e = 0; e < kParticleEvent_Count; ++e) {
+		if (event_queues_[e] != nullptr) {
+			event_queues_[e]->setThreadCount(thread_count);
+			event_queues_[e]->beginBatch();
+		}
+	}
 
-	last_time_ -= deltatime;
-	int initial_alive_particles = alive_particles_;
+	// Far systems spawn less particles and keep less of them alive
+	double spawn_rate_scale = 1.0;
+	if (lod_level_ > 0) spawn_rate_scale = lod_tiers_[lod_level_ - 1].spawn_rate_scale;
 
-	if (!burst_ && last_time_ > 0.0f) return;
+	int free_particles = std::max(getMaxAliveParticles() - alive_particles_, 0);
+	int spawn_count = free_particles;
 
-	// Activate particle on the first one dead
-	for (auto particle : particles_) {
-		if (!particle->alive_) {
-			particle->alive_ = true;
-			particle->position_ = glm::vec3(0.0f, 0.0f, 0.0f);
-			if (!constant_velocity_) {
-				float rz = randFloat(min_velocity_.x, max_velocity_.x);
-				float rx = randFloat(min_velocity_.y, max_velocity_.y);
-				float ry = randFloat(min_velocity_.z, max_velocity_.z);
-				particle->velocity_ = glm::vec3(rz, rx, ry);
-			}
-			else {
-				particle->velocity_ = initial_velocity_;
+	if (!burst_) {
+		// Spawns every particle whose spawn time passed this frame, the remainder is carried to the next one
+		next_spawn_time_ -= deltatime * spawn_rate_scale;
+		if (next_spawn_time_ > 0.0) return;
+
+		double pending_particles = floor(-next_spawn_time_ / emission_rate_) + 1.0;
+		next_spawn_time_ += pending_particles * emission_rate_;
+
+		// Particles that don't fit in the pool are dropped instead of delayed
+		if (pending_particles < free_particles) spawn_count = static_cast<int>(pending_particles);
+	}
+
+	if (spawn_count <= 0) return;
+
+	// New particles go right after the alive ones, the ring pool may wrap them to the beginning of the arrays
+	int spawn_begin[2];
+	int spawn_end[2];
+	int spawn_ranges = getSpawnRanges(spawn_count, spawn_begin, spawn_end);
+	for (int r = 0; r < spawn_ranges; ++r) {
+		initParticles(spawn_begin[r], spawn_end[r] - spawn_begin[r]);
+		spawnPositions(spawn_begin[r], spawn_end[r] - spawn_begin[r]);
+
+		if (event_queues_[kParticleEvent_Birth] != nullptr) {
+			for (int i = spawn_begin[r]; i < spawn_end[r]; ++i) {
+				event_queues_[kParticleEvent_Birth]->push(particles_, i);
 			}
-			alive_particles_++;
-			last_time_ = emission_rate_;
-			if (!burst_) break;
 		}
 	}
+	alive_particles_ += spawn_count;
 
 }
 
 // ------------------------------------------------------------------------- //
 
-void ComponentParticleSystem::update(double deltatime) {
+bool ComponentParticleSystem::advanceLODStep(double deltatime, double* step) {
 
-	for (auto particle : particles_) {
-		if (particle->alive_) {
-			// If particle has exceeded the max lifetime it marks it as dead
-			if (particle->life_time_ > max_life_time_ && max_life_time_ > 0.0f) {
-				particle->alive_ = false;
-				particle->life_time_ = 0.0f;
-				particle->position_ = glm::vec3(0.0f, 0.0f, -10000.0f);
-				--alive_particles_;
-				continue;
-			}
+	int interval = lod_level_ > 0 ? std::max(lod_tiers_[lod_level_ - 1].update_interval, 1) : 1;
+	if (culled_) interval = std::max(interval, offscreen_update_interval_);
 
-			float lerp_value = particle->life_time_ / max_life_time_;
-			
-			//Update color
-			if (lerp_color_) {
-				glm::vec4 color;
-				color.r = glm::smoothstep(initial_color_.r, final_color_.r, lerp_value);
-				color.g = glm::smoothstep(initial_color_.g, final_color_.g, lerp_value);
-				color.b = glm::smoothstep(initial_color_.b, final_color_.b, lerp_value);
-				color.a = glm::smoothstep(initial_color_.a, final_color_.a, lerp_value);
-				particle->color_ = color;
-			}
-			if (lerp_alpha_) {
-				float alpha = glm::smoothstep(initial_color_.a, final_color_.a, lerp_value);
-				particle->color_.a = alpha;
-			}
+	// The skipped time is simulated in a single longer step
+	lod_update_time_ = deltatime;
+	lod_skipped_time_ += deltatime;
+	++lod_update_count_;
+	if ((lod_update_count_ + lod_phase_) % interval != 0) return false;
 
-			//Update speed
-			if (lerp_speed_) {
-				glm::vec3 speed;
-				speed.x = glm::smoothstep(initial_color_.x, final_color_.x, lerp_value);
-				speed.y = glm::smoothstep(initial_color_.y, final_color_.y, lerp_value);
-				speed.z = glm::smoothstep(initial_color_.z, final_color_.z, lerp_value);
-				particle->velocity_ = speed;
-			}
+	*step = lod_skipped_time_;
+	lod_step_time_ = lod_skipped_time_;
+	lod_skipped_time_ = 0.0;
+	return true;
 
-			//Update position and velocity
-			particle->life_time_ += static_cast<float>(deltatime);
-			particle->position_ += particle->velocity_ * static_cast<float>(deltatime);
-		}
-	}
+}
+
+// ------------------------------------------------------------------------- //
+
+float ComponentParticleSystem::getInterpolationAlpha(float update_alpha) {
+
+	if (lod_step_time_ <= 0.0) return update_alpha;
+
+	// The previous positions are a whole step old, the updates skipped since it move the alpha along it
+	double alpha = (lod_skipped_time_ + update_alpha * lod_update_time_) / lod_step_time_;
+	return static_cast<float>(std::min(std::max(alpha, 0.0), 1.0));
 
 }
 
 // ------------------------------------------------------------------------- //
 
-void ComponentParticleSystem::sort() {
+void ComponentParticleSystem::initParticles(int first, int count) {
 
+	for (int i = first; i < first + count; ++i) {
+		particles_.setColor(i, initial_color_);
+		particles_.life_time_[i] = 0.0f;
+		particles_.sort_rank_[i] = ParticleData::kUnsorted;
+	}
 
+	// Velocities of the whole batch generated at once
+	if (!constant_velocity_) {
+		random_.fillVec3(particles_.velocity_x_ + first, particles_.velocity_y_ + first,
+			particles_.velocity_z_ + first, count, min_velocity_, max_velocity_);
+	}
+	else {
+		for (int i = first; i < first + count; ++i) {
+			particles_.setVelocity(i, initial_velocity_);
+		}
+	}
 
 }
 
 // ------------------------------------------------------------------------- //
 
-void ComponentParticleSystem::loadTexture(const char* texture_path) {
+int ComponentParticleSystem::getMaxAliveParticles() {
 
-	auto app_data = ParticleEditor::instance().app_data_;
+	if (lod_level_ == 0) return max_particles_;
+	int max_alive_particles = lod_tiers_[lod_level_ - 1].max_alive_particles;
+	return max_alive_particles > 0 ? std::min(max_particles_, max_alive_particles) : max_particles_;
 
-	// Add texture to load it later when empty
-	auto it = app_data->loaded_textures_.cbegin();
-	if (it == app_data->loaded_textures_.cend()) {
-		// Not any object insert it
-		app_data->loaded_textures_.insert(
-			std::pair<int, const char*>(0, texture_path));
-		// return new id
-		texture_id_ = 0;
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::emitAt(const ParticleEventRecord* events, int count, int per_event,
+	float inherit_velocity, const glm::mat4& source_to_system) {
+
+	// Events that don't fit in the pool or the level of detail are dropped, like the emission
+	int spawn_count = count * per_event;
+	int free_particles = std::max(getMaxAliveParticles() - alive_particles_, 0);
+	if (spawn_count > free_particles) spawn_count = free_particles;
+	if (spawn_count <= 0) return;
+
+	const glm::mat3 source_to_system_direction = glm::mat3(source_to_system);
+
+	int spawn_begin[2];
+	int spawn_end[2];
+	int spawn_ranges = getSpawnRanges(spawn_count, spawn_begin, spawn_end);
+	int n = 0;
+	for (int r = 0; r < spawn_ranges; ++r) {
+		initParticles(spawn_begin[r], spawn_end[r] - spawn_begin[r]);
+		for (int i = spawn_begin[r]; i < spawn_end[r]; ++i, ++n) {
+			const ParticleEventRecord& event = events[n / per_event];
+			glm::vec3 position = glm::vec3(source_to_system * glm::vec4(event.position, 1.0f));
+			glm::vec3 velocity = source_to_system_direction * event.velocity * inherit_velocity;
+			particles_.position_x_[i] = particles_.previous_position_x_[i] = position.x;
+			particles_.position_y_[i] = particles_.previous_position_y_[i] = position.y;
+			particles_.position_z_[i] = particles_.previous_position_z_[i] = position.z;
+			particles_.velocity_x_[i] += velocity.x;
+			particles_.velocity_y_[i] += velocity.y;
+			particles_.velocity_z_[i] += velocity.z;
+		}
+	}
+	int sorted_particles = alive_particles_;
+	alive_particles_ += spawn_count;
+
+	// Spawned after the sort, they are merged into its order with their own keys so it stays sorted
+	if (sort_mode_ != kSortMode_None && draw_order_.size() == static_cast<size_t>(sorted_particles)) {
+		for (int r = 0; r < spawn_ranges; ++r) {
+			for (int i = spawn_begin[r]; i < spawn_end[r]; ++i) {
+				glm::vec3 offset = glm::vec3(sort_to_camera_ * glm::vec4(particles_.getPosition(i), 1.0f));
+				particles_.sort_key_[i] = glm::dot(offset, offset);
+				draw_order_.push_back(static_cast<uint32_t>(i));
+			}
+		}
+		const float* key = particles_.sort_key_;
+		auto farther = [key](uint32_t a, uint32_t b) { return key[a] > key[b]; };
+		std::sort(draw_order_.begin() + sorted_particles, draw_order_.end(), farther);
+		std::inplace_merge(draw_order_.begin(), draw_order_.begin() + sorted_particles, draw_order_.end(), farther);
 	}
 
-	// Check if texture was previously loaded to not load it again
-	it = app_data->loaded_textures_.cbegin();
-	while (it != app_data->loaded_textures_.cend()) {
-		if (!strcmp(texture_path, it->second)) {
-			printf("\nTexture has been loaded earlier. Assigning correspondent id.");
-			// Return previous assigned id
-			texture_id_ = it->first;
+	// The spawned particles may take the slots of births recorded by the last simulation
+	if (event_queues_[kParticleEvent_Birth] != nullptr) {
+		event_queues_[kParticleEvent_Birth]->beginBatch();
+		for (int r = 0; r < spawn_ranges; ++r) {
+			for (int i = spawn_begin[r]; i < spawn_end[r]; ++i) {
+				event_queues_[kParticleEvent_Birth]->push(particles_, i);
+			}
 		}
-		++it;
 	}
 
-	// Save it if its not added yet
-	app_data->loaded_textures_.insert(
-		std::pair<int, const char*>(app_data->loaded_textures_.size(),
-			texture_path));
+}
 
-	// return new id
-	texture_id_ = app_data->loaded_textures_.size() - 1;
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::spawnSubEmitters() {
+
+	if (sub_emitters_.empty()) return;
+
+	// Events are gathered first, a system can be its own sub-emitter and record new births meanwhile
+	for (int e = 0; e < kParticleEvent_Count; ++e) {
+		pending_events_[e].clear();
+		if (event_queues_[e] != nullptr) event_queues_[e]->flush(pending_events_[e]);
+	}
+
+	for (const SubEmitter& sub_emitter : sub_emitters_) {
+		const std::vector<ParticleEventRecord>& events = pending_events_[sub_emitter.event];
+		if (events.empty()) continue;
+		// Events are in the space of this system, the target may be on an entity with another transform
+		glm::mat4 source_to_target = glm::inverse(sub_emitter.target->model_) * model_;
+		sub_emitter.target->emitAt(events.data(), static_cast<int>(events.size()),
+			sub_emitter.particles_per_event, sub_emitter.inherit_velocity, source_to_target);
+	}
 
 }
 
 // ------------------------------------------------------------------------- //
 
-void ComponentParticleSystem::setSpawnArea(float length, float width, float height){
+void ComponentParticleSystem::spawnPositions(int first, int count) {
+
+	float* x = particles_.position_x_ + first;
+	float* y = particles_.position_y_ + first;
+	float* z = particles_.position_z_ + first;
+	const float two_pi = 6.28318530718f;
 
+	if (spawn_scratch_.size() < count) spawn_scratch_.resize(count);
+	float* scratch = spawn_scratch_.data();
+
+	// Random numbers for the whole batch are generated first and transformed after in straight loops
+	switch (spawn_shape_) {
+	case kSpawnShape_Box: {
+		glm::vec3 half_size = spawn_box_size_ * 0.5f;
+		random_.fillVec3(x, y, z, count, -half_size, half_size);
+		break;
+	}
+	case kSpawnShape_Sphere:
+	case kSpawnShape_SphereShell: {
+		// Uniform in volume, the radius cubed is uniform between the inner and outer radius cubed
+		float inner = spawn_shape_ == kSpawnShape_Sphere ? 0.0f : spawn_inner_radius_;
+		float inner_cubed = inner * inner * inner;
+		float outer_cubed = spawn_radius_ * spawn_radius_ * spawn_radius_;
+		random_.fillUnitVectors(x, y, z, count);
+		random_.fillFloats(scratch, count, inner_cubed, outer_cubed);
+		for (int i = 0; i < count; ++i) {
+			float radius = cbrtf(scratch[i]);
+			x[i] *= radius;
+			y[i] *= radius;
+			z[i] *= radius;
+		}
+		break;
+	}
+	case kSpawnShape_Cone: {
+		// Height with a cubic distribution to be uniform in volume, then a uniform point in the disc at that height
+		float tan_angle = tanf(glm::radians(spawn_cone_angle_));
+		random_.fillFloats(z, count, 0.0f, 1.0f);
+		random_.fillFloats(scratch, count, 0.0f, 1.0f);
+		random_.fillFloats(y, count, 0.0f, two_pi);
+		for (int i = 0; i < count; ++i) {
+			float height = spawn_cone_height_ * cbrtf(z[i]);
+			float radius = height * tan_angle * sqrtf(scratch[i]);
+			float angle = y[i];
+			x[i] = radius * cosf(angle);
+			y[i] = radius * sinf(angle);
+			z[i] = height;
+		}
+		break;
+	}
+	case kSpawnShape_Disc: {
+		random_.fillFloats(scratch, count, 0.0f, 1.0f);
+		random_.fillFloats(y, count, 0.0f, two_pi);
+		for (int i = 0; i < count; ++i) {
+			float radius = spawn_radius_ * sqrtf(scratch[i]);
+			float angle = y[i];
+			x[i] = radius * cosf(angle);
+			y[i] = radius * sinf(angle);
+			z[i] = 0.0f;
+		}
+		break;
+	}
+	case kSpawnShape_Line: {
+		glm::vec3 direction = spawn_line_end_ - spawn_line_start_;
+		random_.fillFloats(scratch, count, 0.0f, 1.0f);
+		for (int i = 0; i < count; ++i) {
+			x[i] = spawn_line_start_.x + direction.x * scratch[i];
+			y[i] = spawn_line_start_.y + direction.y * scratch[i];
+			z[i] = spawn_line_start_.z + direction.z * scratch[i];
+		}
+		break;
+	}
+	default: {
+		for (int i = 0; i < count; ++i) {
+			x[i] = 0.0f;
+			y[i] = 0.0f;
+			z[i] = 0.0f;
+		}
+		break;
+	}
+	}
 
+	// Spawned particles have not moved yet
+	memcpy(particles_.previous_position_x_ + first, x, count * sizeof(float));
+	memcpy(particles_.previous_position_y_ + first, y, count * sizeof(float));
+	memcpy(particles_.previous_position_z_ + first, z, count * sizeof(float));
 
 }
 
 // ------------------------------------------------------------------------- //
 
-void ComponentParticleSystem::setEmissionRate(float emission_rate) {
+void ComponentParticleSystem::selectUpdateKernel() {
 
-	if (emission_rate <= 0.0f) return;
-	
-	emission_rate_ = emission_rate;
+	int modules = kParticleUpdateModule_None;
+	if (lerp_color_) modules |= kParticleUpdateModule_LerpColor;
+	if (lerp_alpha_) modules |= kParticleUpdateModule_LerpAlpha;
+	if (lerp_speed_) modules |= kParticleUpdateModule_LerpSpeed;
+	bool has_forces = gravity_ != glm::vec3(0.0f) || wind_ != glm::vec3(0.0f) ||
+		linear_drag_ != 0.0f || quadratic_drag_ != 0.0f || !attractors_.empty();
+	if (has_forces) modules |= kParticleUpdateModule_Forces;
+	if (turbulence_field_ != nullptr || vector_field_ != nullptr) modules |= kParticleUpdateModule_VectorFields;
+
+	update_kernel_ = getParticleUpdateKernel(getParticleInstructionSet(), modules);
 
 }
 
 // ------------------------------------------------------------------------- //
 
-void ComponentParticleSystem::setLifetime(float lifetime) {
+void ComponentParticleSystem::update(double deltatime) {
 
-	max_life_time_ = lifetime;
+	ParticleUpdateParams params;
+	params.delta_time = static_cast<float>(deltatime);
+	params.max_life_time = max_life_time_;
+	params.inv_max_life_time = max_life_time_ > 0.0f ? 1.0f / max_life_time_ : 0.0f;
+	params.curve_last_sample = static_cast<float>(kCurveSamples - 1);
+	for (int c = 0; c < 4; ++c) {
+		params.color_curve[c] = color_curve_[c];
+	}
+	params.alpha_curve = alpha_curve_;
+	for (int c = 0; c < 3; ++c) {
+		params.velocity_curve[c] = velocity_curve_[c];
+	}
+	glm::vec3 acceleration = gravity_ + wind_;
+	for (int c = 0; c < 3; ++c) {
+		params.acceleration[c] = acceleration[c];
+	}
+	params.linear_drag = linear_drag_;
+	params.quadratic_drag = quadratic_drag_;
+	params.attractor_count = static_cast<int>(attractors_.size());
+	params.attractors = attractors_.data();
+	params.vector_field_count = 0;
+	if (turbulence_field_ != nullptr) {
+		// The noise tile holds 8 features, the grid repeats every 8 / frequency units
+		float grid_scale = turbulence_frequency_ * kCurlNoiseResolution / 8.0f;
+		setupVectorFieldSampler(params.vector_fields[params.vector_field_count++], *turbulence_field_,
+			glm::scale(glm::mat4(1.0f), glm::vec3(grid_scale)), true, false, turbulence_strength_);
+	}
+	if (vector_field_ != nullptr) {
+		setupVectorFieldSampler(params.vector_fields[params.vector_field_count++], *vector_field_,
+			getVectorFieldGridTransform(*vector_field_), false, vector_field_force_, vector_field_strength_);
+	}
+	params.collider_count = static_cast<int>(colliders_.size());
+	params.colliders = colliders_.data();
+	params.collision_bounce = collision_bounce_;
+	params.collision_friction = collision_friction_;
+	params.collision_kill = collision_kill_;
+	params.collision_flags = nullptr;
+	if (event_queues_[kParticleEvent_Collision] != nullptr && !colliders_.empty()) {
+		collision_flags_.resize(max_particles_);
+		params.collision_flags = collision_flags_.data();
+	}
+
+	JobSystem* job_system = ParticleEditor::instance().getJobSystem();
+
+	if (ring_layout_) {
+		updateRing(params, job_system);
+		return;
+	}
+
+	// Interactions between particles accumulate into their velocity before they move
+	bool neighbour_modules = separation_strength_ != 0.0f || cohesion_strength_ != 0.0f ||
+		alignment_strength_ != 0.0f || fluid_stiffness_ != 0.0f;
+	if (neighbour_modules && neighbour_radius_ > 0.0f) {
+		updateNeighbours(params.delta_time, job_system);
+	}
+
+	if (self_gravity_ != 0.0f && alive_particles_ > 1) {
+		if (gravity_octree_ == nullptr) gravity_octree_ = new BarnesHutOctree();
+		gravity_octree_->build(particles_.position_x_, particles_.position_y_, particles_.position_z_, alive_particles_);
+		gravity_octree_->applyGravity(self_gravity_, self_gravity_softening_, self_gravity_opening_angle_,
+			params.delta_time, particles_.velocity_x_, particles_.velocity_y_, particles_.velocity_z_, job_system);
+	}
+
+	// Big systems are split in chunks updated by the worker threads, a single thread runs them inline as one job
+	if (job_system != nullptr && job_system->getThreadCount() > 1 && alive_particles_ > kUpdateChunkSize) {
+		updateChunks(params, job_system);
+		return;
+	}
+
+	// Vectorized lifetime, lerps and integration of all the alive particles
+	int dead_particles = update_kernel_(particles_, 0, alive_particles_, params);
+	if (!colliders_.empty()) {
+		dead_particles += collideParticles(params, 0, alive_particles_);
+	}
+	if (dead_particles > 0) {
+		alive_particles_ = compactParticles(0, alive_particles_);
+	}
+
+	computeBounds(0, alive_particles_, &bounds_min_, &bounds_max_);
 
 }
 
 // ------------------------------------------------------------------------- //
 
-void ComponentParticleSystem::setConstantVelocity(glm::vec3 constant_velocity) {
+void ComponentParticleSystem::updateRing(const ParticleUpdateParams& params, JobSystem* job_system) {
+
+	// The particles never move, so the chunks of both ranges don't need to be packed after the update
+	int begin[2];
+	int end[2];
+	int ranges = getAliveRanges(begin, end);
+	for (int r = 0; r < ranges; ++r) {
+		int range_begin = begin[r];
+		auto update_range = [this, &params, range_begin](int chunk_begin, int chunk_end) {
+			update_kernel_(particles_, range_begin + chunk_begin, range_begin + chunk_end, params);
+			if (params.collider_count > 0) {
+				collideParticles(params, range_begin + chunk_begin, range_begin + chunk_end);
+			}
+		};
+		int range_count = end[r] - begin[r];
+		if (job_system != nullptr && job_system->getThreadCount() > 1 && range_count > kUpdateChunkSize) {
+			job_system->parallelFor(range_count, kUpdateChunkSize, update_range);
+		}
+		else {
+			update_range(0, range_count);
+		}
+	}
 
-	initial_velocity_ = constant_velocity;
-	constant_velocity_ = true;
+	// Every particle lives the same time, the ones that reached it are the oldest at the tail
+	ParticleEventQueue* death_events = event_queues_[kParticleEvent_Death];
+	while (alive_particles_ > 0 && particles_.life_time_[ring_tail_] > max_life_time_) {
+		if (death_events != nullptr) death_events->push(particles_, ring_tail_);
+		if (++ring_tail_ == max_particles_) ring_tail_ = 0;
+		--alive_particles_;
+	}
+	if (alive_particles_ == 0) ring_tail_ = 0;
+
+	ranges = getAliveRanges(begin, end);
+	computeBounds(begin[0], end[0], &bounds_min_, &bounds_max_);
+	if (ranges > 1) {
+		glm::vec3 range_min;
+		glm::vec3 range_max;
+		computeBounds(begin[1], end[1], &range_min, &range_max);
+		bounds_min_ = glm::min(bounds_min_, range_min);
+		bounds_max_ = glm::max(bounds_max_, range_max);
+	}
 
 }
 
 // ------------------------------------------------------------------------- //
 
-void ComponentParticleSystem::setInitialVelocity(glm::vec3 min_velocity, glm::vec3 max_velocity) {
+void ComponentParticleSystem::updateChunks(const ParticleUpdateParams& params, JobSystem* job_system) {
 
-	min_velocity_ = min_velocity;
-	max_velocity_ = max_velocity;
-	constant_velocity_ = false;
+	int chunks = (alive_particles_ + kUpdateChunkSize - 1) / kUpdateChunkSize;
+	chunk_alive_particles_.resize(chunks);
+	chunk_bounds_.resize(chunks * 2);
+
+	// Each chunk packs its own alive particles at its beginning
+	job_system->parallelFor(alive_particles_, kUpdateChunkSize, [this, &params](int begin, int end) {
+		int dead_particles = update_kernel_(particles_, begin, end, params);
+		if (params.collider_count > 0) {
+			dead_particles += collideParticles(params, begin, end);
+		}
+		int alive_particles = end - begin;
+		if (dead_particles > 0) {
+			alive_particles = compactParticles(begin, end);
+		}
+		int chunk = begin / kUpdateChunkSize;
+		chunk_alive_particles_[chunk] = alive_particles;
+		computeBounds(begin, begin + alive_particles, &chunk_bounds_[chunk * 2], &chunk_bounds_[chunk * 2 + 1]);
+	});
+
+	// Bounds of the chunks merged, moving the survivors below doesn't change them
+	bounds_min_ = chunk_bounds_[0];
+	bounds_max_ = chunk_bounds_[1];
+	for (int c = 1; c < chunks; ++c) {
+		bounds_min_ = glm::min(bounds_min_, chunk_bounds_[c * 2]);
+		bounds_max_ = glm::max(bounds_max_, chunk_bounds_[c * 2 + 1]);
+	}
+
+	// Reduce the alive count of all the chunks
+	int total_alive_particles = 0;
+	for (int c = 0; c < chunks; ++c) {
+		total_alive_particles += chunk_alive_particles_[c];
+	}
+
+	// Holes below the new alive count are filled with the alive particles above it, there are as many of both
+	int survivor_chunk = chunks - 1;
+	int survivor = 0;
+	int survivor_end = 0;
+	for (int c = 0; c < chunks; ++c) {
+		int chunk_begin = c * kUpdateChunkSize;
+		if (chunk_begin >= total_alive_particles) break;
+
+		int hole_end = std::min(chunk_begin + kUpdateChunkSize, total_alive_particles);
+		for (int hole = chunk_begin + chunk_alive_particles_[c]; hole < hole_end; ++hole) {
+			// Find the next chunk with alive particles above the new alive count
+			while (survivor == survivor_end) {
+				int survivor_begin = survivor_chunk * kUpdateChunkSize;
+				survivor = std::max(survivor_begin, total_alive_particles);
+				survivor_end = survivor_begin + chunk_alive_particles_[survivor_chunk];
+				if (survivor > survivor_end) survivor = survivor_end;
+				--survivor_chunk;
+			}
+			particles_.copy(hole, survivor);
+			++survivor;
+		}
+	}
+
+	alive_particles_ = total_alive_particles;
 
 }
 
 // ------------------------------------------------------------------------- //
 
-void ComponentParticleSystem::setVelocityOverTime(glm::vec3 final_velocity){
+void ComponentParticleSystem::updateNeighbours(float delta_time, JobSystem* job_system) {
 
-	lerp_speed_ = true;
-	final_speed_ = final_velocity;
+	const int count = alive_particles_;
+	if (count == 0) return;
+
+	if (neighbour_grid_ == nullptr) neighbour_grid_ = new SpatialHashGrid();
+	neighbour_grid_->build(particles_.position_x_, particles_.position_y_, particles_.position_z_,
+		count, neighbour_radius_, job_system);
+
+	neighbour_scratch_.resize(count * 4);
+	float* acceleration[3] = { neighbour_scratch_.data(), neighbour_scratch_.data() + count,
+		neighbour_scratch_.data() + count * 2 };
+	float* density = neighbour_scratch_.data() + count * 3;
+
+	const float* x = particles_.position_x_;
+	const float* y = particles_.position_y_;
+	const float* z = particles_.position_z_;
+	const float radius = neighbour_radius_;
+	const float radius_sq = radius * radius;
+	const SpatialHashGrid& grid = *neighbour_grid_;
+
+	auto run = [job_system](int elements, const std::function<void(int begin, int end)>& job) {
+		if (job_system != nullptr) {
+			job_system->parallelFor(elements, kUpdateChunkSize / 4, job);
+		}
+		else {
+			job(0, elements);
+		}
+	};
+
+	// Densities first, the fluid pressure of a pair uses the density of both particles
+	if (fluid_stiffness_ != 0.0f) {
+		run(count, [&](int begin, int end) {
+			for (int i = begin; i < end; ++i) {
+				float particle_density = 0.0f;
+				grid.forEachCandidate(x[i], y[i], z[i], [&](int j) {
+					float dx = x[i] - x[j], dy = y[i] - y[j], dz = z[i] - z[j];
+					float distance_sq = dx * dx + dy * dy + dz * dz;
+					if (j == i || distance_sq >= radius_sq) return;
+					float q = 1.0f - sqrtf(distance_sq) / radius;
+					particle_density += q * q;
+				});
+				density[i] = particle_density;
+			}
+		});
+	}
+
+	const float* vx = particles_.velocity_x_;
+	const float* vy = particles_.velocity_y_;
+	const float* vz = particles_.velocity_z_;
+
+	run(count, [&](int begin, int end) {
+		for (int i = begin; i < end; ++i) {
+			glm::vec3 separation(0.0f), center(0.0f), velocity(0.0f), pressure(0.0f);
+			int neighbours = 0;
+			float particle_pressure = fluid_stiffness_ != 0.0f ? fluid_stiffness_ * (density[i] - fluid_rest_density_) : 0.0f;
+
+			grid.forEachCandidate(x[i], y[i], z[i], [&](int j) {
+				glm::vec3 offset(x[i] - x[j], y[i] - y[j], z[i] - z[j]);
+				float distance_sq = glm::dot(offset, offset);
+				if (j == i || distance_sq >= radius_sq) return;
+
+				++neighbours;
+				center += glm::vec3(x[j], y[j], z[j]);
+				velocity += glm::vec3(vx[j], vy[j], vz[j]);
+
+				// Particles in the same position can't be pushed in any direction
+				float distance = sqrtf(distance_sq);
+				if (distance < 1e-6f) return;
+				glm::vec3 direction = offset / distance;
+				float q = 1.0f - distance / radius;
+				separation += direction * q;
+				if (fluid_stiffness_ != 0.0f) {
+					float neighbour_pressure = fluid_stiffness_ * (density[j] - fluid_rest_density_);
+					pressure += direction * (0.5f * (particle_pressure + neighbour_pressure) * q);
+				}
+			});
+
+			glm::vec3 result = separation * separation_strength_ + pressure;
+			if (neighbours > 0) {
+				float inv_neighbours = 1.0f / neighbours;
+				glm::vec3 position(x[i], y[i], z[i]);
+				glm::vec3 own_velocity(vx[i], vy[i], vz[i]);
+				result += (center * inv_neighbours - position) * cohesion_strength_;
+				result += (velocity * inv_neighbours - own_velocity) * alignment_strength_;
+			}
+			for (int c = 0; c < 3; ++c) {
+				acceleration[c][i] = result[c];
+			}
+		}
+	});
+
+	// Velocities change once all the particles read their neighbours
+	run(count, [&](int begin, int end) {
+		for (int i = begin; i < end; ++i) {
+			particles_.velocity_x_[i] += acceleration[0][i] * delta_time;
+			particles_.velocity_y_[i] += acceleration[1][i] * delta_time;
+			particles_.velocity_z_[i] += acceleration[2][i] * delta_time;
+		}
+	});
 
 }
 
 // ------------------------------------------------------------------------- //
 
-void ComponentParticleSystem::setBurst() {
+void ComponentParticleSystem::computeBounds(int begin, int end, glm::vec3* bounds_min, glm::vec3* bounds_max) {
+
+	// The emitter origin is always inside, so systems without particles are still placed where they spawn
+	float box_min[3] = { 0.0f, 0.0f, 0.0f };
+	float box_max[3] = { 0.0f, 0.0f, 0.0f };
+	// Particles are drawn interpolated between their previous and current positions, both are inside
+	const float* position[6] = { particles_.position_x_, particles_.position_y_, particles_.position_z_,
+		particles_.previous_position_x_, particles_.previous_position_y_, particles_.previous_position_z_ };
+
+	// One array at a time, simple min max loops the compiler vectorizes
+	for (int a = 0; a < 6; ++a) {
+		const float* values = position[a];
+		int c = a % 3;
+		float value_min = box_min[c];
+		float value_max = box_max[c];
+		for (int i = begin; i < end; ++i) {
+			value_min = std::min(value_min, values[i]);
+			value_max = std::max(value_max, values[i]);
+		}
+		box_min[c] = value_min;
+		box_max[c] = value_max;
+	}
 
-	burst_ = true;
+	// Grown to contain the quads drawn around the particles
+	glm::vec3 margin(kParticleDrawSize * 0.5f);
+	*bounds_min = glm::vec3(box_min[0], box_min[1], box_min[2]) - margin;
+	*bounds_max = glm::vec3(box_max[0], box_max[1], box_max[2]) + margin;
 
 }
 
 // ------------------------------------------------------------------------- //
 
-void ComponentParticleSystem::setParticleColor(glm::vec4 color) {
+int ComponentParticleSystem::collideParticles(const ParticleUpdateParams& params, int begin, int end) {
 
-	initial_color_ = color;
+	if (params.collision_flags != nullptr) {
+		memset(params.collision_flags + begin, 0, end - begin);
+	}
 
-	for (auto particle : particles_) {
-		particle->color_ = color;
+	int killed_particles = collision_kernel_(particles_, begin, end, params);
+
+	// Recorded before the compaction moves the particles
+	if (params.collision_flags != nullptr) {
+		for (int i = begin; i < end; ++i) {
+			if (params.collision_flags[i] != 0) event_queues_[kParticleEvent_Collision]->push(particles_, i);
+		}
 	}
 
+	return killed_particles;
+
 }
 
 // ------------------------------------------------------------------------- //
 
-void ComponentParticleSystem::setParticleColorOverTime(glm::vec4 final_color){
+int ComponentParticleSystem::compactParticles(int begin, int end) {
 
-	lerp_color_ = true;
-	final_color_ = final_color;
+	ParticleEventQueue* death_events = event_queues_[kParticleEvent_Death];
+
+	// Particles that exceeded the max lifetime or were killed die, the last alive one takes their place
+	int i = begin;
+	while (i < end) {
+		float life_time = particles_.life_time_[i];
+		bool dead = life_time < 0.0f || (max_life_time_ > 0.0f && life_time > max_life_time_);
+		if (dead) {
+			if (death_events != nullptr) death_events->push(particles_, i);
+			--end;
+			particles_.copy(i, end);
+			continue;
+		}
+		++i;
+	}
+
+	return end - begin;
 
 }
 
 // ------------------------------------------------------------------------- //
 
-void ComponentParticleSystem::setAlphaColorOverTime(float final_alpha){
+void ComponentParticleSystem::sort() {
 
-	lerp_alpha_ = true;
-	final_color_.a = final_alpha;
+	if (sort_mode_ == kSortMode_None || alive_particles_ == 0) {
+		draw_order_.clear();
+		return;
+	}
 
-}
+	JobSystem* job_system = ParticleEditor::instance().getJobSystem();
 
-// ------------------------------------------------------------------------- //
+	// Squared distances in world space, the same order as the distances without the square roots
+	float to_camera[3][4];
+	for (int r = 0; r < 3; ++r) {
+		for (int c = 0; c < 4; ++c) {
+			to_camera[r][c] = sort_to_camera_[c][r];
+		}
+	}
+	static const ParticleSortKeyKernel sort_key_kernel = getParticleSortKeyKernel(getParticleInstructionSet());
+	int begin[2];
+	int end[2];
+	int ranges = getAliveRanges(begin, end);
+	for (int r = 0; r < ranges; ++r) {
+		int range_begin = begin[r];
+		int range_count = end[r] - begin[r];
+		if (job_system != nullptr && job_system->getThreadCount() > 1 && range_count > kUpdateChunkSize) {
+			job_system->parallelFor(range_count, kUpdateChunkSize, [this, &to_camera, range_begin](int chunk_begin, int chunk_end) {
+				sort_key_kernel(particles_, range_begin + chunk_begin, range_begin + chunk_end, to_camera);
+			});
+		}
+		else {
+			sort_key_kernel(particles_, range_begin, range_begin + range_count, to_camera);
+		}
+	}
+
+	// Systems whose order changed too much likely keep changing, they are fully sorted for a few frames
+	const int kIncrementalSortRetryInterval = 8;
+
+	bool sorted = false;
+	if (sort_mode_ == kSortMode_Incremental) {
+		if (incremental_sort_delay_ > 0) {
+			--incremental_sort_delay_;
+		}
+		else {
+			sorted = sortIncremental();
+			if (!sorted) incremental_sort_delay_ = kIncrementalSortRetryInterval;
+		}
+	}
 
-std::vector<Particle*>& ComponentParticleSystem::getAliveParticles() {
+	if (sorted) return;
 
-	std::vector<Particle*> alive_particles = std::vector<Particle*>(0);
+	// The keys of a wrapped ring are gathered in order, the sorted positions are mapped back to the particles after
+	const float* keys = particles_.sort_key_ + begin[0];
+	if (ranges > 1) {
+		ring_sort_keys_.resize(alive_particles_);
+		std::copy(particles_.sort_key_ + begin[0], particles_.sort_key_ + end[0], ring_sort_keys_.begin());
+		std::copy(particles_.sort_key_ + begin[1], particles_.sort_key_ + end[1], ring_sort_keys_.begin() + (end[0] - begin[0]));
+		keys = ring_sort_keys_.data();
+	}
 
-	for (auto particle : particles_) {
-		if (particle->alive_) alive_particles.push_back(particle);
+	if (sorter_ == nullptr) sorter_ = new RadixSorter();
+	draw_order_.resize(alive_particles_);
+	sorter_->sortFloatKeys(keys, alive_particles_, true, draw_order_.data(), job_system);
+	if (ring_layout_) {
+		for (int k = 0; k < alive_particles_; ++k) {
+			draw_order_[k] = static_cast<uint32_t>(getAliveIndex(static_cast<int>(draw_order_[k])));
+		}
 	}
 
-	return alive_particles;
+	// Every particle remembers where it was drawn, the next incremental sort starts from there
+	if (sort_mode_ == kSortMode_Incremental && incremental_sort_delay_ == 0) {
+		for (int k = 0; k < alive_particles_; ++k) {
+			particles_.sort_rank_[draw_order_[k]] = static_cast<uint32_t>(k);
+		}
+	}
 
 }
 
 // ------------------------------------------------------------------------- //
 
-std::vector<Particle*>& ComponentParticleSystem::getAllParticles() {
+bool ComponentParticleSystem::sortIncremental() {
+
+	// Particles that are sorted apart and merged, in percentage of the alive ones, from which the full sort is faster
+	const int kMaxMergedPercentage = 20;
+	// Slots a particle can be away from its place and still be fixed by the insertion pass
+	const int kMaxDisplacement = 16;
+	// Empty slots of the previous order, no entry has all its bits set because the keys are non-negative squared distances
+	// with the sign bit clear, keys that can be negative or NaN would need another sentinel
+	const uint64_t kEmptySlot = ~0ull;
+
+	const int count = alive_particles_;
+	const int previous_count = static_cast<int>(draw_order_.size());
+	if (previous_count == 0) return false;
+	const size_t max_merged = static_cast<size_t>(count) * kMaxMergedPercentage / 100;
+
+	// Packing the pool moved the particles, but their ranks moved with them
+	// Squared distances are positive, their bits order like the floats
+	sort_entries_.assign(previous_count, kEmptySlot);
+	sort_merged_.clear();
+	uint64_t* entries = sort_entries_.data();
+	for (int n = 0; n < count; ++n) {
+		int i = getAliveIndex(n);
+		uint32_t key_bits;
+		memcpy(&key_bits, particles_.sort_key_ + i, sizeof(key_bits));
+		uint64_t entry = (static_cast<uint64_t>(key_bits) << 32) | static_cast<uint32_t>(i);
+		uint32_t rank = particles_.sort_rank_[i];
+		if (rank < static_cast<uint32_t>(previous_count) && entries[rank] == kEmptySlot) {
+			entries[rank] = entry;
+		}
+		else {
+			sort_merged_.push_back(entry);
+		}
+	}
+	if (sort_merged_.size() > max_merged) return false;
+
+	int ranked = 0;
+	for (int slot = 0; slot < previous_count; ++slot) {
+		if (entries[slot] != kEmptySlot) entries[ranked++] = entries[slot];
+	}
+
+	// Particles nearer or farther than the ones kMaxDisplacement slots away moved too much since the previous
+	// frame, they are merged like the new ones so the insertion pass stays linear. They estimate the disorder too
+	// The compared keys are read before the kept particles overwrite them
+	int kept = 0;
+	uint64_t behind[kMaxDisplacement];
+	for (int k = 0; k < ranked; ++k) {
+		uint64_t entry = entries[k];
+		uint32_t key_bits = static_cast<uint32_t>(entry >> 32);
+		bool displaced = (k >= kMaxDisplacement && key_bits > static_cast<uint32_t>(behind[k % kMaxDisplacement] >> 32)) ||
+			(k + kMaxDisplacement < ranked && key_bits < static_cast<uint32_t>(entries[k + kMaxDisplacement] >> 32));
+		behind[k % kMaxDisplacement] = entry;
+		if (displaced) {
+			sort_merged_.push_back(entry);
+			if (sort_merged_.size() > max_merged) return false;
+		}
+		else {
+			entries[kept++] = entry;
+		}
+	}
 
-	return particles_;
+	// Insertion pass over the nearly sorted particles, the index bits break the ties
+	for (int k = 1; k < kept; ++k) {
+		uint64_t entry = entries[k];
+		int m = k;
+		while (m > 0 && entries[m - 1] < entry) {
+			entries[m] = entries[m - 1];
+			--m;
+		}
+		entries[m] = entry;
+	}
+
+	// The rest sorted on their own and merged with them into the draw order, ranking the particles for the next sort
+	std::sort(sort_merged_.begin(), sort_merged_.end(), std::greater<uint64_t>());
+	const uint64_t* merged = sort_merged_.data();
+	const int merged_count = static_cast<int>(sort_merged_.size());
+	draw_order_.resize(count);
+	int next_kept = 0;
+	int next_merged = 0;
+	for (int k = 0; k < count; ++k) {
+		bool take_kept = next_merged == merged_count || (next_kept < kept && entries[next_kept] > merged[next_merged]);
+		uint32_t particle = static_cast<uint32_t>(take_kept ? entries[next_kept++] : merged[next_merged++]);
+		draw_order_[k] = particle;
+		particles_.sort_rank_[particle] = static_cast<uint32_t>(k);
+	}
+
+	return true;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::loadTexture(const char* texture_path) {
+
+	auto app_data = ParticleEditor::instance().app_data_;
+
+	// Add texture to load it later when empty
+	auto it = app_data->loaded_textures_.cbegin();
+	if (it == app_data->loaded_textures_.cend()) {
+		// Not any object insert it
+		app_data->loaded_textures_.insert(
+			std::pair<int, const char*>(0, texture_path));
+		// return new id
+		texture_id_ = 0;
+	}
+
+	// Check if texture was previously loaded to not load it again
+	it = app_data->loaded_textures_.cbegin();
+	while (it != app_data->loaded_textures_.cend()) {
+		if (!strcmp(texture_path, it->second)) {
+			printf("\nTexture has been loaded earlier. Assigning correspondent id.");
+			// Return previous assigned id
+			texture_id_ = it->first;
+		}
+		++it;
+	}
+
+	// Save it if its not added yet
+	app_data->loaded_textures_.insert(
+		std::pair<int, const char*>(app_data->loaded_textures_.size(),
+			texture_path));
+
+	// return new id
+	texture_id_ = app_data->loaded_textures_.size() - 1;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setSpawnArea(float length, float width, float height){
+
+	spawn_shape_ = kSpawnShape_Box;
+	spawn_box_size_ = glm::vec3(length, width, height);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setSpawnSphere(float radius) {
+
+	spawn_shape_ = kSpawnShape_Sphere;
+	spawn_radius_ = radius;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setSpawnSphereShell(float inner_radius, float outer_radius) {
+
+	if (inner_radius > outer_radius) return;
+
+	spawn_shape_ = kSpawnShape_SphereShell;
+	spawn_inner_radius_ = inner_radius;
+	spawn_radius_ = outer_radius;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setSpawnCone(float angle_degrees, float height) {
+
+	spawn_shape_ = kSpawnShape_Cone;
+	spawn_cone_angle_ = angle_degrees;
+	spawn_cone_height_ = height;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setSpawnDisc(float radius) {
+
+	spawn_shape_ = kSpawnShape_Disc;
+	spawn_radius_ = radius;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setSpawnLine(glm::vec3 start, glm::vec3 end) {
+
+	spawn_shape_ = kSpawnShape_Line;
+	spawn_line_start_ = start;
+	spawn_line_end_ = end;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setEmissionRate(float emission_rate) {
+
+	if (emission_rate <= 0.0f) return;
+	
+	emission_rate_ = emission_rate;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setLifetime(float lifetime) {
+
+	max_life_time_ = lifetime;
+	updatePoolLayout();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setConstantVelocity(glm::vec3 constant_velocity) {
+
+	initial_velocity_ = constant_velocity;
+	constant_velocity_ = true;
+	if (velocity_over_time_) setVelocityOverTime(final_velocity_);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setInitialVelocity(glm::vec3 min_velocity, glm::vec3 max_velocity) {
+
+	min_velocity_ = min_velocity;
+	max_velocity_ = max_velocity;
+	constant_velocity_ = false;
+	if (velocity_over_time_) setVelocityOverTime(final_velocity_);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setVelocityOverTime(glm::vec3 final_velocity){
+
+	// Random initial velocities start the curve from the middle of their range
+	glm::vec3 initial_velocity = constant_velocity_ ? initial_velocity_ : (min_velocity_ + max_velocity_) * 0.5f;
+	setVelocityOverLifetime({ { 0.0f, initial_velocity }, { 1.0f, final_velocity } });
+	velocity_over_time_ = true;
+	final_velocity_ = final_velocity;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setVelocityOverLifetime(const std::vector<ParticleVectorKey>& keys) {
+
+	if (keys.empty()) return;
+
+	velocity_over_time_ = false;
+	for (int c = 0; c < 3; ++c) {
+		bakeCurve(keys, velocity_curve_[c], kCurveSamples, [c](const ParticleVectorKey& key) { return key.value[c]; });
+	}
+	lerp_speed_ = true;
+	selectUpdateKernel();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setGravity(glm::vec3 gravity) {
+
+	gravity_ = gravity;
+	selectUpdateKernel();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setWind(glm::vec3 wind) {
+
+	wind_ = wind;
+	selectUpdateKernel();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setDrag(float linear_drag, float quadratic_drag) {
+
+	if (linear_drag < 0.0f || quadratic_drag < 0.0f) return;
+
+	linear_drag_ = linear_drag;
+	quadratic_drag_ = quadratic_drag;
+	selectUpdateKernel();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+int ComponentParticleSystem::addAttractor(glm::vec3 position, float strength, float radius) {
+
+	ParticleAttractor attractor;
+	attractor.position = position;
+	attractor.strength = strength;
+	attractor.radius_sq = radius > 0.0f ? radius * radius : FLT_MAX;
+	attractors_.push_back(attractor);
+	selectUpdateKernel();
+
+	return static_cast<int>(attractors_.size()) - 1;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setAttractorPosition(int index, glm::vec3 position) {
+
+	if (index < 0 || index >= attractors_.size()) return;
+
+	attractors_[index].position = position;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::clearAttractors() {
+
+	attractors_.clear();
+	selectUpdateKernel();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setTurbulence(float strength, float frequency, uint32_t seed) {
+
+	if (frequency <= 0.0f) return;
+
+	turbulence_strength_ = strength;
+	turbulence_frequency_ = frequency;
+	turbulence_field_ = strength != 0.0f ? getCurlNoiseField(seed) : nullptr;
+	selectUpdateKernel();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setVectorField(const char* path, float strength, bool as_force) {
+
+	vector_field_ = getVectorFieldAsset(path);
+	vector_field_strength_ = strength;
+	vector_field_force_ = as_force;
+	selectUpdateKernel();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::clearVectorField() {
+
+	vector_field_ = nullptr;
+	selectUpdateKernel();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+int ComponentParticleSystem::addCollisionPlane(glm::vec3 normal, float distance) {
+
+	ParticleCollider collider = {};
+	collider.shape = ParticleCollider::kShape_Plane;
+	collider.normal = glm::normalize(normal);
+	collider.distance = distance;
+	colliders_.push_back(collider);
+
+	return static_cast<int>(colliders_.size()) - 1;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+int ComponentParticleSystem::addCollisionSphere(glm::vec3 center, float radius, bool container) {
+
+	ParticleCollider collider = {};
+	collider.shape = ParticleCollider::kShape_Sphere;
+	collider.center = center;
+	collider.radius = radius;
+	collider.side = container ? -1.0f : 1.0f;
+	colliders_.push_back(collider);
+
+	return static_cast<int>(colliders_.size()) - 1;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+int ComponentParticleSystem::addCollisionBox(glm::vec3 box_min, glm::vec3 box_max) {
+
+	ParticleCollider collider = {};
+	collider.shape = ParticleCollider::kShape_Box;
+	collider.box_min = glm::min(box_min, box_max);
+	collider.box_max = glm::max(box_min, box_max);
+	colliders_.push_back(collider);
+
+	return static_cast<int>(colliders_.size()) - 1;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::clearColliders() {
+
+	colliders_.clear();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setCollisionResponse(float bounce, float friction, bool kill) {
+
+	collision_bounce_ = bounce;
+	collision_friction_ = glm::clamp(friction, 0.0f, 1.0f);
+	collision_kill_ = kill;
+	updatePoolLayout();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setNeighbourRadius(float radius) {
+
+	if (radius < 0.0f) return;
+
+	neighbour_radius_ = radius;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setSeparation(float strength) {
+
+	separation_strength_ = strength;
+	updatePoolLayout();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setCohesion(float strength) {
+
+	cohesion_strength_ = strength;
+	updatePoolLayout();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setAlignment(float strength) {
+
+	alignment_strength_ = strength;
+	updatePoolLayout();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setFluid(float stiffness, float rest_density) {
+
+	fluid_stiffness_ = stiffness;
+	fluid_rest_density_ = rest_density;
+	updatePoolLayout();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setSelfGravity(float gravity, float softening, float opening_angle) {
+
+	self_gravity_ = gravity;
+	self_gravity_softening_ = fabsf(softening);
+	self_gravity_opening_angle_ = std::max(opening_angle, 0.0f);
+	updatePoolLayout();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::addSubEmitter(ParticleEvent event, ComponentParticleSystem* target,
+	int particles_per_event, float inherit_velocity) {
+
+	if (target == nullptr || particles_per_event <= 0) return;
+
+	if (event_queues_[event] == nullptr) event_queues_[event] = new ParticleEventQueue();
+	sub_emitters_.push_back({ event, target, particles_per_event, inherit_velocity });
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::clearSubEmitters() {
+
+	sub_emitters_.clear();
+	for (int e = 0; e < kParticleEvent_Count; ++e) {
+		delete event_queues_[e];
+		event_queues_[e] = nullptr;
+	}
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::addLODTier(float distance, float spawn_rate_scale, int max_alive_particles,
+	int update_interval) {
+
+	ParticleLODTier tier = { distance, std::max(spawn_rate_scale, 0.0f), std::max(max_alive_particles, 0),
+		std::max(update_interval, 1) };
+	lod_tiers_.push_back(tier);
+
+	std::stable_sort(lod_tiers_.begin(), lod_tiers_.end(),
+		[](const ParticleLODTier& a, const ParticleLODTier& b) { return a.distance < b.distance; });
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::clearLODTiers() {
+
+	lod_tiers_.clear();
+	lod_level_ = 0;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setLODHysteresis(float hysteresis) {
+
+	lod_hysteresis_ = glm::clamp(hysteresis, 0.0f, 1.0f);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setSortMode(SortMode sort_mode) {
+
+	sort_mode_ = sort_mode;
+	draw_order_.clear();
+	incremental_sort_delay_ = 0;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setPoolMode(PoolMode pool_mode) {
+
+	pool_mode_ = pool_mode;
+	updatePoolLayout();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+bool ComponentParticleSystem::isRingPoolSupported() {
+
+	// Particles leave the ring only at its tail, the particles of these modules would have to move or die before their time
+	bool neighbour_modules = separation_strength_ != 0.0f || cohesion_strength_ != 0.0f ||
+		alignment_strength_ != 0.0f || fluid_stiffness_ != 0.0f;
+	return max_life_time_ > 0.0f && !collision_kill_ && !neighbour_modules && self_gravity_ == 0.0f;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::updatePoolLayout() {
+
+	bool ring_layout = pool_mode_ == kPoolMode_Ring && isRingPoolSupported();
+	if (ring_layout == ring_layout_) return;
+
+	if (ring_layout) {
+		// Packed particles are in any order, the ring needs the oldest first so they die at its tail
+		const int count = alive_particles_;
+		const float* life_time = particles_.life_time_;
+		std::vector<int> order(count);
+		for (int i = 0; i < count; ++i) {
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [life_time](int a, int b) { return life_time[a] > life_time[b]; });
+
+		// Placed with swaps, keeping where every particle is and which particle is in every slot
+		std::vector<int> slot_of(order.size());
+		std::vector<int> particle_in(order.size());
+		for (int i = 0; i < count; ++i) {
+			slot_of[i] = particle_in[i] = i;
+		}
+		for (int k = 0; k < count; ++k) {
+			int slot = slot_of[order[k]];
+			if (slot == k) continue;
+			particles_.swap(k, slot);
+			int displaced = particle_in[k];
+			particle_in[slot] = displaced;
+			slot_of[displaced] = slot;
+			particle_in[k] = order[k];
+			slot_of[order[k]] = k;
+		}
+	}
+	else {
+		// The wrapped particles are already at the beginning of the arrays, the older ones are moved after them
+		int begin[2];
+		int end[2];
+		int ranges = getAliveRanges(begin, end);
+		int packed = ranges > 1 ? end[1] : 0;
+		for (int i = begin[0]; i < end[0]; ++i) {
+			particles_.copy(packed++, i);
+		}
+	}
+
+	ring_layout_ = ring_layout;
+	ring_tail_ = 0;
+
+	// The draw order pointed to the old slots
+	sort();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+int ComponentParticleSystem::getAliveRanges(int begin[2], int end[2]) {
+
+	begin[0] = ring_layout_ ? ring_tail_ : 0;
+	end[0] = begin[0] + alive_particles_;
+	if (end[0] <= max_particles_) return 1;
+
+	// The ring wraps, the newest particles are at the beginning of the arrays
+	begin[1] = 0;
+	end[1] = end[0] - max_particles_;
+	end[0] = max_particles_;
+	return 2;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+int ComponentParticleSystem::getSpawnRanges(int count, int begin[2], int end[2]) {
+
+	begin[0] = getAliveIndex(alive_particles_);
+	end[0] = begin[0] + count;
+	if (end[0] <= max_particles_) return 1;
+
+	begin[1] = 0;
+	end[1] = end[0] - max_particles_;
+	end[0] = max_particles_;
+	return 2;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setOffscreenUpdateInterval(int interval) {
+
+	offscreen_update_interval_ = std::max(interval, 1);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::updateLOD(float camera_distance) {
+
+	// Tiers change only once the distance is past their threshold by the hysteresis margin
+	int tier_count = static_cast<int>(lod_tiers_.size());
+	int level = std::min(lod_level_, tier_count);
+	while (level < tier_count && camera_distance > lod_tiers_[level].distance * (1.0f + lod_hysteresis_)) {
+		++level;
+	}
+	while (level > 0 && camera_distance < lod_tiers_[level - 1].distance * (1.0f - lod_hysteresis_)) {
+		--level;
+	}
+
+	lod_level_ = level;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setRandomSeed(uint32_t seed) {
+
+	random_.setSeed(seed);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setBurst() {
+
+	burst_ = true;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setParticleColor(glm::vec4 color) {
+
+	initial_color_ = color;
+
+	for (int i = 0; i < max_particles_; ++i) {
+		particles_.setColor(i, color);
+	}
+
+	// The over time presets start from the particle color
+	if (color_over_time_) setParticleColorOverTime(final_color_);
+	if (alpha_over_time_) setAlphaColorOverTime(final_alpha_);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setParticleColorOverTime(glm::vec4 final_color){
+
+	setColorOverLifetime({ { 0.0f, initial_color_ }, { 1.0f, final_color } });
+	color_over_time_ = true;
+	final_color_ = final_color;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setAlphaColorOverTime(float final_alpha){
+
+	setAlphaOverLifetime({ { 0.0f, initial_color_.a }, { 1.0f, final_alpha } });
+	alpha_over_time_ = true;
+	final_alpha_ = final_alpha;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setColorOverLifetime(const std::vector<ParticleColorKey>& keys) {
+
+	if (keys.empty()) return;
+
+	color_over_time_ = false;
+	for (int c = 0; c < 4; ++c) {
+		bakeCurve(keys, color_curve_[c], kCurveSamples, [c](const ParticleColorKey& key) { return key.color[c]; });
+	}
+	lerp_color_ = true;
+	selectUpdateKernel();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ComponentParticleSystem::setAlphaOverLifetime(const std::vector<ParticleFloatKey>& keys) {
+
+	if (keys.empty()) return;
+
+	alpha_over_time_ = false;
+	bakeCurve(keys, alpha_curve_, kCurveSamples, [](const ParticleFloatKey& key) { return key.value; });
+	lerp_alpha_ = true;
+	selectUpdateKernel();
 
 }
 
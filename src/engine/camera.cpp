@@ -15,6 +15,7 @@
 
 Camera::Camera() {
 
+  projection_ = glm::mat4(1.0f);
   position_ = glm::vec3(0.0f, 0.0f, -2.0f);
   rotation_ = glm::vec3(-45.0f, 0.0f, -90.0f);
   view_pos_ = glm::vec4();
@@ -61,7 +62,8 @@ void Camera::updateViewMatrix() {
 
   //trans_mat = glm::translate(glm::mat4(1.0f), position_);
 
-  //view_ = trans_mat * rot_mat ;
+  view_ = rot_mat;
+  updateFrustumPlanes();
 
   view_pos_ = glm::vec4(position_, 0.0f) * glm::vec4(-1.0f, 1.0f, -1.0f, 1.0f);
 
@@ -104,7 +106,8 @@ void Camera::updateViewMatrix(glm::vec2 new_mouse_pos) {
 
   //trans_mat = glm::translate(glm::mat4(1.0f), position_);
 
-  //view_ = trans_mat * rot_mat ;
+  view_ = rot_mat;
+  updateFrustumPlanes();
 
 	view_pos_ = glm::vec4(position_, 0.0f) * glm::vec4(-1.0f, 1.0f, -1.0f, 1.0f);
 
@@ -140,6 +143,15 @@ glm::mat4 Camera::getProjectionMatrix() {
 
 // ------------------------------------------------------------------------- // 
 
+glm::vec3 Camera::getPosition() {
+
+  // The view matrix moves the world in front of the camera, its inverse places the camera in the world
+  return glm::vec3(glm::inverse(view_)[3]);
+
+}
+
+// ------------------------------------------------------------------------- // 
+
 void Camera::zoom(float wheel_offset){
 
   glm::vec3 front_ = glm::vec3(0.0f, 0.0f, 0.0f) - position_;
@@ -151,3 +163,62 @@ void Camera::zoom(float wheel_offset){
 }
 
 // ------------------------------------------------------------------------- // 
+
+void Camera::updateFrustumPlanes() {
+
+  // Rows of the view projection combined as in Gribb & Hartmann, the clip depth goes from 0 to 1
+  glm::mat4 view_projection = projection_ * view_;
+  glm::vec4 row[4];
+  for (int r = 0; r < 4; ++r) {
+    row[r] = glm::vec4(view_projection[0][r], view_projection[1][r], view_projection[2][r], view_projection[3][r]);
+  }
+
+  frustum_planes_[0] = row[3] + row[0];
+  frustum_planes_[1] = row[3] - row[0];
+  frustum_planes_[2] = row[3] + row[1];
+  frustum_planes_[3] = row[3] - row[1];
+  frustum_planes_[4] = row[2];
+  frustum_planes_[5] = row[3] - row[2];
+
+  for (int p = 0; p < 6; ++p) {
+    float length = glm::length(glm::vec3(frustum_planes_[p]));
+    if (length > 0.0f) frustum_planes_[p] /= length;
+  }
+
+}
+
+// ------------------------------------------------------------------------- // 
+
+bool Camera::isSphereVisible(glm::vec3 center, float radius) {
+
+  for (int p = 0; p < 6; ++p) {
+    if (glm::dot(glm::vec3(frustum_planes_[p]), center) + frustum_planes_[p].w < -radius) return false;
+  }
+
+  return true;
+
+}
+
+// ------------------------------------------------------------------------- // 
+
+bool Camera::isBoxVisible(glm::vec3 box_min, glm::vec3 box_max, const glm::mat4& model) {
+
+  // World space box around the transformed one, its extents are the absolute sum of the rotated axes
+  glm::vec3 local_center = (box_min + box_max) * 0.5f;
+  glm::vec3 local_extents = (box_max - box_min) * 0.5f;
+  glm::vec3 center = glm::vec3(model * glm::vec4(local_center, 1.0f));
+  glm::vec3 extents = glm::abs(glm::vec3(model[0])) * local_extents.x +
+    glm::abs(glm::vec3(model[1])) * local_extents.y + glm::abs(glm::vec3(model[2])) * local_extents.z;
+
+  // Out if it is completely behind any plane
+  for (int p = 0; p < 6; ++p) {
+    glm::vec3 normal = glm::vec3(frustum_planes_[p]);
+    float radius = glm::dot(glm::abs(normal), extents);
+    if (glm::dot(normal, center) + frustum_planes_[p].w < -radius) return false;
+  }
+
+  return true;
+
+}
+
+// ------------------------------------------------------------------------- // 
@@ -0,0 +1,227 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+// ------------------------------------------------------------------------- //
+
+#include "engine/job_system.h"
+
+// ------------------------------------------------------------------------- //
+
+// Index of the thread in the job system, threads outside of it use the first deque
+static thread_local int thread_index_ = 0;
+
+// ------------------------------------------------------------------------- //
+
+JobSystem::JobSystem() {
+
+	queued_jobs_ = 0;
+	running_ = false;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+JobSystem::~JobSystem() {
+
+	shutDown();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void JobSystem::init(int worker_threads) {
+
+	if (running_) return;
+
+	if (worker_threads <= 0) {
+		int hardware_threads = static_cast<int>(std::thread::hardware_concurrency());
+		worker_threads = hardware_threads > 1 ? hardware_threads - 1 : 0;
+	}
+
+	// One deque for the calling thread plus one per worker
+	queues_.resize(worker_threads + 1);
+	for (int i = 0; i < queues_.size(); ++i) {
+		queues_[i] = new WorkerQueue();
+	}
+
+	thread_index_ = 0;
+	running_ = true;
+
+	for (int i = 1; i <= worker_threads; ++i) {
+		workers_.push_back(std::thread(&JobSystem::workerLoop, this, i));
+	}
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void JobSystem::shutDown() {
+
+	if (!running_) return;
+
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex_);
+		running_ = false;
+	}
+	wake_condition_.notify_all();
+
+	for (int i = 0; i < workers_.size(); ++i) {
+		workers_[i].join();
+	}
+	workers_.clear();
+
+	// Jobs left in the deques are finished in the calling thread
+	QueuedJob queued_job;
+	while (findJob(0, queued_job)) {
+		execute(queued_job);
+	}
+
+	for (int i = 0; i < queues_.size(); ++i) {
+		delete queues_[i];
+	}
+	queues_.clear();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void JobSystem::run(Job job, JobCounter* counter) {
+
+	// Without workers the job is executed straight away
+	if (queues_.empty()) {
+		job();
+		return;
+	}
+
+	if (counter != nullptr) counter->pending_.fetch_add(1);
+
+	WorkerQueue* queue = queues_[getThreadIndex()];
+	{
+		std::lock_guard<std::mutex> lock(queue->mutex_);
+		queue->jobs_.push_back({ std::move(job), counter });
+	}
+	queued_jobs_.fetch_add(1);
+
+	// Taking the lock ensures that a worker about to sleep sees the new job
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex_);
+	}
+	wake_condition_.notify_one();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void JobSystem::wait(JobCounter* counter) {
+
+	int thread_index = getThreadIndex();
+	QueuedJob queued_job;
+
+	while (counter->pending_.load() > 0) {
+		if (findJob(thread_index, queued_job)) {
+			execute(queued_job);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void JobSystem::parallelFor(int count, int chunk_size,
+	const std::function<void(int begin, int end)>& job) {
+
+	if (count <= 0) return;
+	if (chunk_size <= 0) chunk_size = count;
+
+	// Not worth to split it
+	if (count <= chunk_size || getThreadCount() <= 1) {
+		job(0, count);
+		return;
+	}
+
+	JobCounter counter;
+	for (int begin = 0; begin < count; begin += chunk_size) {
+		int end = begin + chunk_size < count ? begin + chunk_size : count;
+		run([&job, begin, end]() { job(begin, end); }, &counter);
+	}
+	wait(&counter);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+int JobSystem::getThreadIndex() {
+
+	return thread_index_;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void JobSystem::workerLoop(int thread_index) {
+
+	thread_index_ = thread_index;
+	QueuedJob queued_job;
+
+	while (running_) {
+		if (findJob(thread_index, queued_job)) {
+			execute(queued_job);
+			continue;
+		}
+
+		// Sleep until new jobs are queued
+		std::unique_lock<std::mutex> lock(sleep_mutex_);
+		wake_condition_.wait(lock, [this]() { return queued_jobs_.load() > 0 || !running_; });
+	}
+
+}
+
+// ------------------------------------------------------------------------- //
+
+bool JobSystem::findJob(int thread_index, QueuedJob& queued_job) {
+
+	// Newest job of the own deque first, it is more likely to be in cache
+	{
+		WorkerQueue* queue = queues_[thread_index];
+		std::lock_guard<std::mutex> lock(queue->mutex_);
+		if (!queue->jobs_.empty()) {
+			queued_job = std::move(queue->jobs_.back());
+			queue->jobs_.pop_back();
+			queued_jobs_.fetch_sub(1);
+			return true;
+		}
+	}
+
+	// Steal the oldest job of another thread
+	int threads = static_cast<int>(queues_.size());
+	for (int i = 1; i < threads; ++i) {
+		WorkerQueue* queue = queues_[(thread_index + i) % threads];
+		std::lock_guard<std::mutex> lock(queue->mutex_);
+		if (!queue->jobs_.empty()) {
+			queued_job = std::move(queue->jobs_.front());
+			queue->jobs_.pop_front();
+			queued_jobs_.fetch_sub(1);
+			return true;
+		}
+	}
+
+	return false;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void JobSystem::execute(QueuedJob& queued_job) {
+
+	queued_job.job_();
+	queued_job.job_ = nullptr;
+
+	if (queued_job.counter_ != nullptr) queued_job.counter_->pending_.fetch_sub(1);
+
+}
+
+// ------------------------------------------------------------------------- //
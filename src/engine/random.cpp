@@ -0,0 +1,160 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+// ------------------------------------------------------------------------- //
+
+#include "engine/random.h"
+
+#include <cmath>
+
+// ------------------------------------------------------------------------- //
+
+// Converts the 24 high bits of a random number to a float in [0, 1)
+static inline float toUnitFloat(uint32_t value) {
+
+	return static_cast<float>(value >> 8) * (1.0f / 16777216.0f);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+// SplitMix64, used to expand the seed into the streams state
+static inline uint64_t splitMix64(uint64_t& state) {
+
+	uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+RandomGenerator::RandomGenerator(uint32_t seed) {
+
+	setSeed(seed);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void RandomGenerator::setSeed(uint32_t seed) {
+
+	uint64_t split_state = seed;
+	for (int s = 0; s < kStreams; ++s) {
+		uint64_t a = splitMix64(split_state);
+		uint64_t b = splitMix64(split_state);
+		state_[0][s] = static_cast<uint32_t>(a);
+		state_[1][s] = static_cast<uint32_t>(a >> 32);
+		state_[2][s] = static_cast<uint32_t>(b);
+		state_[3][s] = static_cast<uint32_t>(b >> 32);
+		// The state can't be all zeros
+		if ((state_[0][s] | state_[1][s] | state_[2][s] | state_[3][s]) == 0) state_[0][s] = 1;
+	}
+
+	buffered_count_ = 0;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void RandomGenerator::nextUInts(uint32_t* dst) {
+
+	// xoshiro128+ step for the four streams, written per stream so it gets vectorized
+	for (int s = 0; s < kStreams; ++s) {
+		dst[s] = state_[0][s] + state_[3][s];
+
+		uint32_t t = state_[1][s] << 9;
+		state_[2][s] ^= state_[0][s];
+		state_[3][s] ^= state_[1][s];
+		state_[1][s] ^= state_[2][s];
+		state_[0][s] ^= state_[3][s];
+		state_[2][s] ^= t;
+		state_[3][s] = (state_[3][s] << 11) | (state_[3][s] >> 21);
+	}
+
+}
+
+// ------------------------------------------------------------------------- //
+
+uint32_t RandomGenerator::nextUInt() {
+
+	if (buffered_count_ == 0) {
+		nextUInts(buffered_);
+		buffered_count_ = kStreams;
+	}
+
+	--buffered_count_;
+	return buffered_[buffered_count_];
+
+}
+
+// ------------------------------------------------------------------------- //
+
+float RandomGenerator::nextFloat() {
+
+	return toUnitFloat(nextUInt());
+
+}
+
+// ------------------------------------------------------------------------- //
+
+float RandomGenerator::nextFloat(float min, float max) {
+
+	return min + nextFloat() * (max - min);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void RandomGenerator::fillFloats(float* dst, int count, float min, float max) {
+
+	const float range = max - min;
+	uint32_t values[kStreams];
+
+	int i = 0;
+	for (; i + kStreams <= count; i += kStreams) {
+		nextUInts(values);
+		for (int s = 0; s < kStreams; ++s) {
+			dst[i + s] = min + toUnitFloat(values[s]) * range;
+		}
+	}
+
+	for (; i < count; ++i) {
+		dst[i] = min + nextFloat() * range;
+	}
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void RandomGenerator::fillVec3(float* dst_x, float* dst_y, float* dst_z, int count,
+	glm::vec3 min, glm::vec3 max) {
+
+	fillFloats(dst_x, count, min.x, max.x);
+	fillFloats(dst_y, count, min.y, max.y);
+	fillFloats(dst_z, count, min.z, max.z);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void RandomGenerator::fillUnitVectors(float* dst_x, float* dst_y, float* dst_z, int count) {
+
+	const float two_pi = 6.28318530718f;
+
+	// Uniform height and angle around it, the output arrays are used as scratch
+	fillFloats(dst_z, count, -1.0f, 1.0f);
+	fillFloats(dst_x, count, 0.0f, two_pi);
+
+	for (int i = 0; i < count; ++i) {
+		float radius = sqrtf(fmaxf(0.0f, 1.0f - dst_z[i] * dst_z[i]));
+		float angle = dst_x[i];
+		dst_x[i] = radius * cosf(angle);
+		dst_y[i] = radius * sinf(angle);
+	}
+
+}
+
+// ------------------------------------------------------------------------- //
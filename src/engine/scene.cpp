@@ -9,8 +9,12 @@
 #include "engine/scene.h"
 #include "systems/system.h"
 #include "components/component_particle_system.h"
+#include "components/component_transform.h"
+#include "particle_editor.h"
 
 #include <stdexcept>
+#include <algorithm>
+#include <matrix_transform.hpp>
 
 // ------------------------------------------------------------------------- //
 
@@ -81,14 +85,66 @@ void Scene::init(){
 
 void Scene::update(double time){
 
+	JobSystem* job_system = ParticleEditor::instance().getJobSystem();
+	JobSystem::JobCounter counter;
+	Camera* camera = ParticleEditor::instance().getCamera();
+
+	// Each particle system is simulated in its own job
 	for (int i = 0; i < particle_entities_.size(); ++i){
 
 		auto ps = static_cast<ComponentParticleSystem*>
 			(particle_entities_[i]->getComponent(Component::ComponentKind::kComponentKind_ParticleSystem));
-		ps->emit(time);
-		ps->update(time);
-		ps->sort();
 
+		auto transform = static_cast<ComponentTransform*>
+			(particle_entities_[i]->getComponent(Component::ComponentKind::kComponentKind_Transform));
+		glm::mat4 model = transform->getModelMatrix();
+		ps->model_ = model;
+
+		if (camera != nullptr) {
+			// Level of detail from the distance between the camera and the emitter
+			glm::vec3 emitter_position = glm::vec3(model[3]);
+			ps->updateLOD(glm::distance(camera->getPosition(), emitter_position));
+
+			// Particles are sorted by their distance to the camera in world space
+			ps->sort_to_camera_ = glm::translate(glm::mat4(1.0f), -camera->getPosition()) * model;
+
+			// Culled with the bounds of the last update, the sphere rejects quickly and the box is tighter
+			glm::vec3 sphere_center = glm::vec3(model * glm::vec4(ps->getBoundingSphereCenter(), 1.0f));
+			float max_scale = std::max(glm::length(glm::vec3(model[0])),
+				std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+			ps->culled_ = !camera->isSphereVisible(sphere_center, ps->getBoundingSphereRadius() * max_scale) ||
+				!camera->isBoxVisible(ps->getBoundsMin(), ps->getBoundsMax(), model);
+		}
+
+		// Far systems skip updates and simulate the skipped time in a single step
+		double step = 0.0;
+		if (!ps->advanceLODStep(time, &step)) continue;
+
+		JobSystem::Job simulation = [ps, step]() {
+			ps->emit(step);
+			ps->update(step);
+			ps->sort();
+		};
+
+		if (job_system != nullptr) {
+			job_system->run(simulation, &counter);
+		}
+		else {
+			simulation();
+		}
+
+	}
+
+	// Join all the systems before drawing them
+	if (job_system != nullptr) {
+		job_system->wait(&counter);
+	}
+
+	// Particles spawned by the events of all the systems, in a single pass once none of them is simulating
+	for (int i = 0; i < particle_entities_.size(); ++i) {
+		auto ps = static_cast<ComponentParticleSystem*>
+			(particle_entities_[i]->getComponent(Component::ComponentKind::kComponentKind_ParticleSystem));
+		ps->spawnSubEmitters();
 	}
 
 }
@@ -56,6 +56,7 @@ ParticleEditor::AppData::AppData() {
   system_draw_objects_ = new SystemDrawObjects();
   system_draw_translucents_ = new SystemDrawTranslucents();
   system_draw_particles_ = new SystemDrawParticles();
+  system_sort_ = new SystemSort();
 
 }
 
@@ -66,6 +67,7 @@ ParticleEditor::AppData::~AppData(){
   delete system_draw_objects_;
   delete system_draw_translucents_;
   delete system_draw_particles_;
+  delete system_sort_;
 
 }
 
@@ -552,7 +554,7 @@ void ParticleEditor::AppData::createCommandPool() {
   VkCommandPoolCreateInfo command_pool_info{};
   command_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
   command_pool_info.queueFamilyIndex = indices.graphics_family.value();
-  command_pool_info.flags = 0; // VK_COMMAND_POOL_CREATE_TRANSIENT_BIT means that command buffers will be rerecorded with new commands very often
+  command_pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT; // Command buffers are rerecorded each frame with the alive particles
 
   if (vkCreateCommandPool(logical_device_, &command_pool_info, nullptr, &command_pool_) != VK_SUCCESS) {
     throw std::runtime_error("\nFailed to create command pool.");
@@ -805,53 +807,60 @@ void ParticleEditor::AppData::createCommandBuffers() {
     throw std::runtime_error("\nFailed to create command buffers.");
   }
 
-  auto scene = ParticleEditor::instance().getScene();
-
   // Record the command buffers
   for (int i = 0; i < command_buffers_.size(); i++) {
-    // Begin command buffers recording
-    VkCommandBufferBeginInfo begin_info{};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = 0;
-    begin_info.pInheritanceInfo = nullptr;
-
-    if (vkBeginCommandBuffer(command_buffers_[i], &begin_info) != VK_SUCCESS) {
-      throw std::runtime_error("\nFailed to begin command buffer recording.");
-    }
+    recordCommandBuffer(i);
+  }
 
-    // Set the render pass begin info
-    VkRenderPassBeginInfo render_pass_begin{};
-    render_pass_begin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    render_pass_begin.renderPass = render_pass_;
-    render_pass_begin.framebuffer = swap_chain_framebuffers_[i];
-    render_pass_begin.renderArea.offset = { 0, 0 };
-    render_pass_begin.renderArea.extent = swap_chain_extent_;
-    std::array<VkClearValue, 2> clear_values{};
-    clear_values[0].color = { 0.0f, 0.0f, 0.0f, 1.0f }; // Black
-    clear_values[1].depthStencil = { 1.0f, 0 };
-    render_pass_begin.clearValueCount = static_cast<uint32_t>(clear_values.size());
-    render_pass_begin.pClearValues = clear_values.data();
-
-    // Begin recording the commands on the command buffer
-    vkCmdBeginRenderPass(command_buffers_[i], &render_pass_begin, VK_SUBPASS_CONTENTS_INLINE);
-
-    // Call draw systems to prepare the commands for all the entities
-    system_draw_objects_->addDrawCommands(i, command_buffers_[i], 
-      scene->getEntities(0)); // opaque entities
-
-		system_draw_translucents_->addDrawCommands(i, command_buffers_[i],
-      scene->getEntities(1)); // translucent entities
-
-		system_draw_particles_->addParticlesDrawCommand(i, command_buffers_[i],
-			scene->getEntities(2)); // particle system entities
-
-    // Finish recording commands
-    vkCmdEndRenderPass(command_buffers_[i]);
-
-    if (vkEndCommandBuffer(command_buffers_[i]) != VK_SUCCESS) {
-      throw std::runtime_error("\nFailed to end command buffer recording.");
-    }
+}
+
+// ------------------------------------------------------------------------- //
 
+void ParticleEditor::AppData::recordCommandBuffer(uint32_t image) {
+
+  auto scene = ParticleEditor::instance().getScene();
+
+  // Begin command buffers recording, it implicitly resets the previous recording
+  VkCommandBufferBeginInfo begin_info{};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.flags = 0;
+  begin_info.pInheritanceInfo = nullptr;
+
+  if (vkBeginCommandBuffer(command_buffers_[image], &begin_info) != VK_SUCCESS) {
+    throw std::runtime_error("\nFailed to begin command buffer recording.");
+  }
+
+  // Set the render pass begin info
+  VkRenderPassBeginInfo render_pass_begin{};
+  render_pass_begin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+  render_pass_begin.renderPass = render_pass_;
+  render_pass_begin.framebuffer = swap_chain_framebuffers_[image];
+  render_pass_begin.renderArea.offset = { 0, 0 };
+  render_pass_begin.renderArea.extent = swap_chain_extent_;
+  std::array<VkClearValue, 2> clear_values{};
+  clear_values[0].color = { 0.0f, 0.0f, 0.0f, 1.0f }; // Black
+  clear_values[1].depthStencil = { 1.0f, 0 };
+  render_pass_begin.clearValueCount = static_cast<uint32_t>(clear_values.size());
+  render_pass_begin.pClearValues = clear_values.data();
+
+  // Begin recording the commands on the command buffer
+  vkCmdBeginRenderPass(command_buffers_[image], &render_pass_begin, VK_SUBPASS_CONTENTS_INLINE);
+
+  // Call draw systems to prepare the commands for all the entities
+  system_draw_objects_->addDrawCommands(image, command_buffers_[image],
+    scene->getEntities(0)); // opaque entities
+
+  system_draw_translucents_->addDrawCommands(image, command_buffers_[image],
+    scene->getEntities(1)); // translucent entities
+
+  system_draw_particles_->addParticlesDrawCommand(image, command_buffers_[image],
+    scene->getEntities(2)); // particle system entities
+
+  // Finish recording commands
+  vkCmdEndRenderPass(command_buffers_[image]);
+
+  if (vkEndCommandBuffer(command_buffers_[image]) != VK_SUCCESS) {
+    throw std::runtime_error("\nFailed to end command buffer recording.");
   }
 
 }
@@ -896,8 +905,10 @@ void ParticleEditor::AppData::updateUniformBuffers(uint32_t current_image) {
   // translucent entities
 	system_draw_translucents_->updateUniformBuffers(current_image, scene->getEntities(1)); 
 
-  // particles entities
-  system_draw_particles_->updateUniformBuffers(current_image, scene->getEntities(2));
+  // particles entities, the systems sorted their particles in the last update and they are merged in a single order
+  std::vector<Entity*> particle_entities = scene->getEntities(2);
+  system_sort_->sortParticles(particle_entities);
+  system_draw_particles_->updateUniformBuffers(current_image, particle_entities);
 
 }
 
@@ -933,6 +944,9 @@ void ParticleEditor::AppData::drawFrame() {
   // Update the uniform buffers
   updateUniformBuffers(image_index);
 
+  // Record the draw commands again, only the alive particles are drawn
+  recordCommandBuffer(image_index);
+
   // Execute the command buffer with that image as attachment in the framebuffer
   VkSubmitInfo submit_info{};
   submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
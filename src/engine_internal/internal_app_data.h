@@ -14,6 +14,7 @@
 #include "systems/system_draw_objects.h"
 #include "systems/system_draw_particles.h"
 #include "systems/system_draw_translucents.h"
+#include "systems/system_sort.h"
 #include "../src/engine_internal/internal_gpu_resources.h"
 #include "../src/engine_internal/internal_materials.h"
 
@@ -72,6 +73,7 @@ struct ParticleEditor::AppData {
 	SystemDrawObjects* system_draw_objects_;
 	SystemDrawTranslucents* system_draw_translucents_;
 	SystemDrawParticles* system_draw_particles_;
+	SystemSort* system_sort_;
 
 
 
@@ -133,6 +135,8 @@ struct ParticleEditor::AppData {
   void createIndexBuffer(std::vector<uint32_t>& indices);
   // Creates the command buffers for each swap chain framebuffer
   void createCommandBuffers();
+  // Records the draw commands of the scene in the command buffer of a swap chain image
+  void recordCommandBuffer(uint32_t image);
   // Creates the semaphores needed for rendering
   void createSyncObjects();
 
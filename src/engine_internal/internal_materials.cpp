@@ -228,9 +228,11 @@ void Material::updateSceneUBO(int buffer_id) {
 
 // ------------------------------------------------------------------------- //
 
-void Material::updateModelsUBO(int buffer_id) {
+void Material::updateModelsUBO(int buffer_id, int objects) {
 
-	uint32_t objects = ParticleEditor::instance().getScene()->getNumberOfObjects(material_id_);
+	if (objects < 0) {
+		objects = ParticleEditor::instance().getScene()->getNumberOfObjects(material_id_);
+	}
 	uint32_t size = objects * models_dynamic_alignment_;
 
 	for (int i = 0; i < objects; ++i) {
@@ -663,9 +665,11 @@ void OpaqueMaterial::createDescriptorPools() {
 
 // ------------------------------------------------------------------------- //
 
-void OpaqueMaterial::updateSpecificUBO(int buffer_id) {
+void OpaqueMaterial::updateSpecificUBO(int buffer_id, int objects) {
 
-	uint32_t objects = ParticleEditor::instance().getScene()->getNumberOfObjects(material_id_);
+	if (objects < 0) {
+		objects = ParticleEditor::instance().getScene()->getNumberOfObjects(material_id_);
+	}
 	uint32_t size = objects * specific_dynamic_alignment_;
 
 	for (int i = 0; i < objects; ++i) {
@@ -1146,9 +1150,11 @@ void TranslucentMaterial::createDescriptorPools() {
 
 // ------------------------------------------------------------------------- //
 
-void TranslucentMaterial::updateSpecificUBO(int buffer_id) {
+void TranslucentMaterial::updateSpecificUBO(int buffer_id, int objects) {
 
-	uint32_t objects = ParticleEditor::instance().getScene()->getNumberOfObjects(material_id_);
+	if (objects < 0) {
+		objects = ParticleEditor::instance().getScene()->getNumberOfObjects(material_id_);
+	}
 	uint32_t size = objects * specific_dynamic_alignment_;
 
 	for (int i = 0; i < objects; ++i) {
@@ -1629,9 +1635,11 @@ void ParticlesMaterial::createDescriptorPools(){
 
 // ------------------------------------------------------------------------- //
 
-void ParticlesMaterial::updateSpecificUBO(int buffer_id){
+void ParticlesMaterial::updateSpecificUBO(int buffer_id, int objects){
 
-	uint32_t objects = ParticleEditor::instance().getScene()->getNumberOfObjects(material_id_);
+	if (objects < 0) {
+		objects = ParticleEditor::instance().getScene()->getNumberOfObjects(material_id_);
+	}
 	uint32_t size = objects * specific_dynamic_alignment_;
 
 	for (int i = 0; i < objects; ++i) {
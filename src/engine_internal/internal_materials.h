@@ -67,10 +67,10 @@ public:
 
 	// Updates the scene uniform buffer
 	void updateSceneUBO(int buffer_id);
-	// Updates the object models dynamic buffer
-	void updateModelsUBO(int buffer_id);
-	// Updates the object specific pipeline dynamic buffer
-	virtual void updateSpecificUBO(int buffer_id) {}
+	// Updates the object models dynamic buffer, only the first given objects if objects is not negative
+	void updateModelsUBO(int buffer_id, int objects = -1);
+	// Updates the object specific pipeline dynamic buffer, only the first given objects if objects is not negative
+	virtual void updateSpecificUBO(int buffer_id, int objects = -1) {}
 
 	// Clean up all the uniform buffers
 	void cleanUniformBuffers();
@@ -156,7 +156,7 @@ public:
 	virtual void createDescriptorPools() override;
 
 	// Updates the object specific opaque dynamic buffer
-	virtual void updateSpecificUBO(int buffer_id) override;
+	virtual void updateSpecificUBO(int buffer_id, int objects = -1) override;
 
 protected:
 	// Creates the opaque uniform dynamic buffers
@@ -186,7 +186,7 @@ public:
 	virtual void createDescriptorPools() override;
 
 	// Updates the object specific translucent dynamic buffer
-	virtual void updateSpecificUBO(int buffer_id) override;
+	virtual void updateSpecificUBO(int buffer_id, int objects = -1) override;
 
 protected:
 	// Creates the translucent uniform dynamic buffers
@@ -215,7 +215,7 @@ public:
 	virtual void createDescriptorPools() override;
 
 	// Updates the object specific particles dynamic buffer
-	virtual void updateSpecificUBO(int buffer_id) override;
+	virtual void updateSpecificUBO(int buffer_id, int objects = -1) override;
 
 protected:
 	// Creates the particles uniform dynamic buffers
@@ -0,0 +1,279 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+// ------------------------------------------------------------------------- //
+
+#include "../src/engine_internal/internal_octree.h"
+#include "../src/engine_internal/internal_particle_kernels.h"
+#include "engine/job_system.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+// ------------------------------------------------------------------------- //
+
+// Leaves evaluated by each job
+static const int kGravityChunkSize = 64;
+// Particles of a leaf evaluated together by the gravity kernel, a multiple of 8 as the kernels require
+static const int kGravityBatchSize = 32;
+
+// ------------------------------------------------------------------------- //
+
+BarnesHutOctree::BarnesHutOctree() {
+
+  for (int c = 0; c < 3; ++c) {
+    build_position_[c] = nullptr;
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+BarnesHutOctree::~BarnesHutOctree() {
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void BarnesHutOctree::build(const float* x, const float* y, const float* z, int count) {
+
+  nodes_.clear();
+  leaves_.clear();
+  if (count <= 0) return;
+
+  // Root cube around all the particles
+  float bounds_min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+  float bounds_max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+  build_position_[0] = x;
+  build_position_[1] = y;
+  build_position_[2] = z;
+  for (int c = 0; c < 3; ++c) {
+    const float* position = build_position_[c];
+    for (int i = 0; i < count; ++i) {
+      bounds_min[c] = std::min(bounds_min[c], position[i]);
+      bounds_max[c] = std::max(bounds_max[c], position[i]);
+    }
+  }
+  float half_size = 0.0f;
+  for (int c = 0; c < 3; ++c) {
+    half_size = std::max(half_size, 0.5f * (bounds_max[c] - bounds_min[c]));
+  }
+  half_size = half_size * 1.001f + 1e-6f;
+
+  sorted_indices_.resize(count);
+  scratch_indices_.resize(count);
+  for (int i = 0; i < count; ++i) {
+    sorted_indices_[i] = i;
+  }
+
+  nodes_.resize(1);
+  buildNode(0, 0.5f * (bounds_min[0] + bounds_max[0]), 0.5f * (bounds_min[1] + bounds_max[1]),
+    0.5f * (bounds_min[2] + bounds_max[2]), half_size, 0, count, 0);
+
+  // Positions in tree order, the leaves read them contiguously
+  for (int c = 0; c < 3; ++c) {
+    sorted_position_[c].resize(count);
+    for (int i = 0; i < count; ++i) {
+      sorted_position_[c][i] = build_position_[c][sorted_indices_[i]];
+    }
+    build_position_[c] = nullptr;
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void BarnesHutOctree::buildNode(int node, float center_x, float center_y, float center_z, float half_size,
+  int first, int count, int depth) {
+
+  nodes_[node].size = half_size * 2.0f;
+  nodes_[node].first = first;
+  nodes_[node].count = count;
+  nodes_[node].mass = static_cast<float>(count);
+  nodes_[node].first_child = -1;
+
+  if (count <= kLeafSize || depth >= kMaxDepth) {
+    if (count > 0) leaves_.push_back(node);
+    float center_of_mass[3] = { 0.0f, 0.0f, 0.0f };
+    for (int s = first; s < first + count; ++s) {
+      for (int c = 0; c < 3; ++c) {
+        center_of_mass[c] += build_position_[c][sorted_indices_[s]];
+      }
+    }
+    for (int c = 0; c < 3; ++c) {
+      nodes_[node].center_of_mass[c] = count > 0 ? center_of_mass[c] / count : 0.0f;
+    }
+    return;
+  }
+
+  // Counting sort of the particles by octant, bit 0 is x, bit 1 is y and bit 2 is z
+  const float* x = build_position_[0];
+  const float* y = build_position_[1];
+  const float* z = build_position_[2];
+  int octant_count[8] = { 0 };
+  for (int s = first; s < first + count; ++s) {
+    int i = sorted_indices_[s];
+    int octant = (x[i] >= center_x ? 1 : 0) | (y[i] >= center_y ? 2 : 0) | (z[i] >= center_z ? 4 : 0);
+    ++octant_count[octant];
+  }
+  int octant_first[8];
+  int offset = first;
+  for (int o = 0; o < 8; ++o) {
+    octant_first[o] = offset;
+    offset += octant_count[o];
+  }
+  int octant_next[8];
+  std::copy(octant_first, octant_first + 8, octant_next);
+  for (int s = first; s < first + count; ++s) {
+    int i = sorted_indices_[s];
+    int octant = (x[i] >= center_x ? 1 : 0) | (y[i] >= center_y ? 2 : 0) | (z[i] >= center_z ? 4 : 0);
+    scratch_indices_[octant_next[octant]++] = i;
+  }
+  std::copy(scratch_indices_.begin() + first, scratch_indices_.begin() + first + count,
+    sorted_indices_.begin() + first);
+
+  // Children are contiguous, the vector may grow while building them so the node is accessed by index
+  int first_child = static_cast<int>(nodes_.size());
+  nodes_[node].first_child = first_child;
+  nodes_.resize(nodes_.size() + 8);
+
+  float quarter_size = half_size * 0.5f;
+  float center_of_mass[3] = { 0.0f, 0.0f, 0.0f };
+  for (int o = 0; o < 8; ++o) {
+    buildNode(first_child + o,
+      center_x + ((o & 1) ? quarter_size : -quarter_size),
+      center_y + ((o & 2) ? quarter_size : -quarter_size),
+      center_z + ((o & 4) ? quarter_size : -quarter_size),
+      quarter_size, octant_first[o], octant_count[o], depth + 1);
+
+    const Node& child = nodes_[first_child + o];
+    for (int c = 0; c < 3; ++c) {
+      center_of_mass[c] += child.center_of_mass[c] * child.mass;
+    }
+  }
+  for (int c = 0; c < 3; ++c) {
+    nodes_[node].center_of_mass[c] = center_of_mass[c] / count;
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void BarnesHutOctree::applyGravity(float gravity, float softening, float opening_angle, float delta_time,
+  float* velocity_x, float* velocity_y, float* velocity_z, JobSystem* job_system) {
+
+  if (nodes_.empty()) return;
+
+  const float softening_sq = softening * softening;
+  const float opening_angle_sq = opening_angle * opening_angle;
+  const float impulse = gravity * delta_time;
+  const int leaf_count = static_cast<int>(leaves_.size());
+  const ParticleGravityKernel gravity_kernel = getParticleGravityKernel(getParticleInstructionSet());
+
+  int thread_count = job_system != nullptr ? job_system->getThreadCount() : 1;
+  if (thread_count > static_cast<int>(thread_interactions_.size())) {
+    thread_interactions_.resize(thread_count);
+  }
+
+  auto job = [&](int begin, int end) {
+    std::vector<float>* interaction = thread_interactions_[JobSystem::getThreadIndex()].source;
+    // Every level pushes at most 8 children and pops one
+    int stack[kMaxDepth * 8 + 8];
+
+    for (int l = begin; l < end; ++l) {
+      const Node& leaf = nodes_[leaves_[l]];
+      const int leaf_end = leaf.first + leaf.count;
+
+      // Box of the leaf particles, a node is far for all of them when it is far from the box
+      float box_min[3], box_max[3];
+      for (int c = 0; c < 3; ++c) {
+        box_min[c] = box_max[c] = sorted_position_[c][leaf.first];
+        for (int s = leaf.first + 1; s < leaf_end; ++s) {
+          box_min[c] = std::min(box_min[c], sorted_position_[c][s]);
+          box_max[c] = std::max(box_max[c], sorted_position_[c][s]);
+        }
+      }
+
+      for (int c = 0; c < 4; ++c) {
+        interaction[c].clear();
+      }
+
+      int stack_size = 0;
+      stack[stack_size++] = 0;
+      while (stack_size > 0) {
+        const Node& node = nodes_[stack[--stack_size]];
+
+        float distance_sq = 0.0f;
+        for (int c = 0; c < 3; ++c) {
+          float outside = std::max(std::max(box_min[c] - node.center_of_mass[c], node.center_of_mass[c] - box_max[c]), 0.0f);
+          distance_sq += outside * outside;
+        }
+
+        // Far enough nodes pull as a single mass
+        if (node.size * node.size < opening_angle_sq * distance_sq) {
+          for (int c = 0; c < 3; ++c) {
+            interaction[c].push_back(node.center_of_mass[c]);
+          }
+          interaction[3].push_back(node.mass);
+          continue;
+        }
+
+        if (node.first_child >= 0) {
+          for (int o = 0; o < 8; ++o) {
+            if (nodes_[node.first_child + o].count > 0) stack[stack_size++] = node.first_child + o;
+          }
+          continue;
+        }
+
+        // Near leaves add all their particles
+        for (int c = 0; c < 3; ++c) {
+          interaction[c].insert(interaction[c].end(), sorted_position_[c].begin() + node.first,
+            sorted_position_[c].begin() + node.first + node.count);
+        }
+        interaction[3].insert(interaction[3].end(), node.count, 1.0f);
+      }
+
+      const float* const sources[4] = { interaction[0].data(), interaction[1].data(), interaction[2].data(),
+        interaction[3].data() };
+      const int source_count = static_cast<int>(interaction[3].size());
+
+      // Leaves at the maximum depth may have more particles than a batch
+      for (int batch = leaf.first; batch < leaf_end; batch += kGravityBatchSize) {
+        int batch_count = std::min(kGravityBatchSize, leaf_end - batch);
+
+        // Padding lanes repeat the last particle and are ignored
+        int padded_count = (batch_count + 7) & ~7;
+        float target[3][kGravityBatchSize];
+        float acceleration[3][kGravityBatchSize];
+        for (int c = 0; c < 3; ++c) {
+          for (int t = 0; t < padded_count; ++t) {
+            target[c][t] = sorted_position_[c][batch + std::min(t, batch_count - 1)];
+            acceleration[c][t] = 0.0f;
+          }
+        }
+        const float* const targets[3] = { target[0], target[1], target[2] };
+        float* const accelerations[3] = { acceleration[0], acceleration[1], acceleration[2] };
+        gravity_kernel(targets, padded_count, sources, source_count, softening_sq, accelerations);
+
+        for (int t = 0; t < batch_count; ++t) {
+          int i = sorted_indices_[batch + t];
+          velocity_x[i] += acceleration[0][t] * impulse;
+          velocity_y[i] += acceleration[1][t] * impulse;
+          velocity_z[i] += acceleration[2][t] * impulse;
+        }
+      }
+    }
+  };
+
+  if (job_system != nullptr) {
+    job_system->parallelFor(leaf_count, kGravityChunkSize, job);
+  }
+  else {
+    job(0, leaf_count);
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
@@ -0,0 +1,79 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+#ifndef __INTERNAL_OCTREE_H__
+#define __INTERNAL_OCTREE_H__
+
+// ------------------------------------------------------------------------- //
+
+#include <vector>
+
+class JobSystem;
+
+// ------------------------------------------------------------------------- //
+
+// Octree of the particle positions for Barnes-Hut gravity, all the particles have the same mass
+// Far nodes are approximated by a single mass in their center of mass, which makes the
+// force evaluation O(n log n) instead of the O(n^2) of the direct summation
+// The tree is walked once per leaf instead of once per particle, the walk gathers the masses that
+// act on the whole leaf and all its particles sum them in a loop the compiler can vectorize
+class BarnesHutOctree {
+public:
+  BarnesHutOctree();
+  ~BarnesHutOctree();
+
+  // Rebuilds the tree around the positions, the particles are stored in tree order
+  void build(const float* x, const float* y, const float* z, int count);
+
+  // Adds to the velocities of the particles the tree was built with the gravity of all of them during delta_time
+  // Nodes seen under an angle (size / distance) smaller than opening_angle are not opened, 0 gives the exact sum
+  // Softening avoids infinite accelerations between close particles
+  // The leaves are split in the job system if there is one
+  void applyGravity(float gravity, float softening, float opening_angle, float delta_time,
+    float* velocity_x, float* velocity_y, float* velocity_z, JobSystem* job_system);
+
+private:
+  struct Node {
+    float center_of_mass[3];
+    float mass;
+    // Side of the node cube
+    float size;
+    // Index of the first of the 8 children, -1 in the leaves
+    int first_child;
+    // Particles of the node in the tree order arrays
+    int first;
+    int count;
+  };
+
+  // Particles per leaf, the direct sum is cheaper than opening more nodes under it
+  static const int kLeafSize = 32;
+  // Limits the depth when many particles share the same position
+  static const int kMaxDepth = 20;
+
+  // Masses acting on the leaf being evaluated, far nodes and the particles of the near leaves
+  // Each thread only uses its own, indexed by JobSystem::getThreadIndex, they keep their memory between frames
+  struct Interactions {
+    std::vector<float> source[4];
+  };
+
+  // Fills the node with the particles [first, first + count) of the tree order, splitting them in children
+  void buildNode(int node, float center_x, float center_y, float center_z, float half_size,
+    int first, int count, int depth);
+
+  std::vector<Node> nodes_;
+  // Index of every leaf with particles
+  std::vector<int> leaves_;
+  // Particle indices and positions in tree order, the particles of every node are contiguous
+  std::vector<int> sorted_indices_;
+  std::vector<float> sorted_position_[3];
+  // Positions being built and partition buffer used by the build
+  const float* build_position_[3];
+  std::vector<int> scratch_indices_;
+  std::vector<Interactions> thread_interactions_;
+
+};
+
+// ------------------------------------------------------------------------- //
+
+#endif // __INTERNAL_OCTREE_H__
@@ -0,0 +1,78 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+// ------------------------------------------------------------------------- //
+
+#include "../src/engine_internal/internal_particle_events.h"
+#include "engine/job_system.h"
+
+#include <algorithm>
+
+// ------------------------------------------------------------------------- //
+
+ParticleEventQueue::ParticleEventQueue() {
+
+  buffers_.resize(1);
+  batch_ = 0;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+ParticleEventQueue::~ParticleEventQueue() {
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ParticleEventQueue::setThreadCount(int thread_count) {
+
+  if (thread_count > static_cast<int>(buffers_.size())) {
+    buffers_.resize(thread_count);
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ParticleEventQueue::beginBatch() {
+
+  ++batch_;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ParticleEventQueue::push(const ParticleData& particles, int index) {
+
+  TaggedEvent event;
+  event.order = (static_cast<uint64_t>(batch_) << 32) | static_cast<uint32_t>(index);
+  event.record.position = particles.getPosition(index);
+  event.record.velocity = particles.getVelocity(index);
+
+  buffers_[JobSystem::getThreadIndex()].events.push_back(event);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void ParticleEventQueue::flush(std::vector<ParticleEventRecord>& events) {
+
+  flushed_.clear();
+  for (ThreadBuffer& buffer : buffers_) {
+    flushed_.insert(flushed_.end(), buffer.events.begin(), buffer.events.end());
+    buffer.events.clear();
+  }
+
+  // Events sharing the order come from the same buffer, the stable sort keeps them as they were recorded
+  std::stable_sort(flushed_.begin(), flushed_.end(), [](const TaggedEvent& a, const TaggedEvent& b) {
+    return a.order < b.order;
+  });
+  for (const TaggedEvent& event : flushed_) {
+    events.push_back(event.record);
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
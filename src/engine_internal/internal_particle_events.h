@@ -0,0 +1,61 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+#ifndef __INTERNAL_PARTICLE_EVENTS_H__
+#define __INTERNAL_PARTICLE_EVENTS_H__
+
+// ------------------------------------------------------------------------- //
+
+#include <vector>
+#include <cstdint>
+#include "components/component_particle_system.h"
+
+// ------------------------------------------------------------------------- //
+
+// Events of one kind raised while simulating a system
+// Every thread appends only to its own buffer, indexed by JobSystem::getThreadIndex, so recording
+// needs no locks or atomics. The buffers are read once the simulation jobs are joined
+// Events are read in batch and particle order, which chunk each thread ran never changes the order
+class ParticleEventQueue {
+public:
+  ParticleEventQueue();
+  ~ParticleEventQueue();
+
+  // Makes room for the threads of the job system, must not run while the events are being recorded
+  void setThreadCount(int thread_count);
+
+  // Events recorded after this go after the ones already recorded, whatever their particles
+  // Called before every serial phase that records events, must not run while the events are being recorded
+  void beginBatch();
+
+  // Records the particle in the buffer of the calling thread
+  void push(const ParticleData& particles, int index);
+
+  // Appends the events of all the threads to the vector, in batch and particle order, and empties the buffers
+  void flush(std::vector<ParticleEventRecord>& events);
+
+private:
+  // Batch in the high bits and particle index in the low ones, only the events of a particle in a batch share it
+  // and a single thread records them in order
+  struct TaggedEvent {
+    uint64_t order;
+    ParticleEventRecord record;
+  };
+
+  // Padded so the threads don't write to the same cache line when their vectors grow
+  struct ThreadBuffer {
+    std::vector<TaggedEvent> events;
+    char padding[64];
+  };
+
+  std::vector<ThreadBuffer> buffers_;
+  uint32_t batch_;
+  // Events of all the threads gathered to be sorted
+  std::vector<TaggedEvent> flushed_;
+
+};
+
+// ------------------------------------------------------------------------- //
+
+#endif // __INTERNAL_PARTICLE_EVENTS_H__
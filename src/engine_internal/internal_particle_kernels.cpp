@@ -0,0 +1,1039 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+// ------------------------------------------------------------------------- //
+
+#include "../src/engine_internal/internal_particle_kernels.h"
+#include "components/component_particle_system.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// ------------------------------------------------------------------------- //
+
+// MSVC allows AVX2 intrinsics without compiling the whole project for AVX2,
+// other compilers only get that path when AVX2 is enabled for the build
+#if defined(_MSC_VER) || (defined(__AVX2__) && defined(__FMA__))
+#define PARTICLE_KERNELS_AVX2
+#endif
+
+// ------------------------------------------------------------------------- //
+// ------------------------------ SIMD LANES ------------------------------- //
+// ------------------------------------------------------------------------- //
+
+// Number of lanes set in a movemask result
+static inline int countBits(int mask) {
+
+  int count = 0;
+  while (mask != 0) {
+    mask &= mask - 1;
+    ++count;
+  }
+  return count;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+// Wrappers over the intrinsics so the kernels are written once for every width
+struct LaneSSE {
+  typedef __m128 Float;
+  static const int kWidth = 4;
+
+  static Float load(const float* src) { return _mm_loadu_ps(src); }
+  static void store(float* dst, Float value) { _mm_storeu_ps(dst, value); }
+  static Float set(float value) { return _mm_set1_ps(value); }
+  static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+  static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+  static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+  static Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+  static Float sqrt(Float a) { return _mm_sqrt_ps(a); }
+  // Approximation refined with a Newton-Raphson step, around 23 bits of precision
+  static Float rsqrt(Float a) {
+    Float r = _mm_rsqrt_ps(a);
+    return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), r),
+      _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_mul_ps(a, r), r)));
+  }
+  static Float mulAdd(Float a, Float b, Float c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+  static Float min(Float a, Float b) { return _mm_min_ps(a, b); }
+  static Float max(Float a, Float b) { return _mm_max_ps(a, b); }
+  static Float greater(Float a, Float b) { return _mm_cmpgt_ps(a, b); }
+  static Float maskAnd(Float a, Float b) { return _mm_and_ps(a, b); }
+  static Float select(Float mask, Float a, Float b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+  static int maskCount(Float mask) { return countBits(_mm_movemask_ps(mask)); }
+  static int maskBits(Float mask) { return _mm_movemask_ps(mask); }
+
+  typedef __m128i Int;
+  static Int truncate(Float value) { return _mm_cvttps_epi32(value); }
+  static Float toFloat(Int value) { return _mm_cvtepi32_ps(value); }
+  // There is no gather before AVX2, the indices go through memory
+  static Float gather(const float* table, Int index) {
+    alignas(16) int i[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(i), index);
+    return _mm_setr_ps(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+  }
+};
+
+#ifdef PARTICLE_KERNELS_AVX2
+struct LaneAVX2 {
+  typedef __m256 Float;
+  static const int kWidth = 8;
+
+  static Float load(const float* src) { return _mm256_loadu_ps(src); }
+  static void store(float* dst, Float value) { _mm256_storeu_ps(dst, value); }
+  static Float set(float value) { return _mm256_set1_ps(value); }
+  static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+  static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+  static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+  static Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+  static Float sqrt(Float a) { return _mm256_sqrt_ps(a); }
+  static Float rsqrt(Float a) {
+    Float r = _mm256_rsqrt_ps(a);
+    return _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), r),
+      _mm256_fnmadd_ps(_mm256_mul_ps(a, r), r, _mm256_set1_ps(3.0f)));
+  }
+  static Float mulAdd(Float a, Float b, Float c) { return _mm256_fmadd_ps(a, b, c); }
+  static Float min(Float a, Float b) { return _mm256_min_ps(a, b); }
+  static Float max(Float a, Float b) { return _mm256_max_ps(a, b); }
+  static Float greater(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+  static Float maskAnd(Float a, Float b) { return _mm256_and_ps(a, b); }
+  static Float select(Float mask, Float a, Float b) { return _mm256_blendv_ps(b, a, mask); }
+  static int maskCount(Float mask) { return countBits(_mm256_movemask_ps(mask)); }
+  static int maskBits(Float mask) { return _mm256_movemask_ps(mask); }
+
+  typedef __m256i Int;
+  static Int truncate(Float value) { return _mm256_cvttps_epi32(value); }
+  static Float toFloat(Int value) { return _mm256_cvtepi32_ps(value); }
+  static Float gather(const float* table, Int index) { return _mm256_i32gather_ps(table, index, 4); }
+};
+#endif
+
+// ------------------------------------------------------------------------- //
+// ---------------------------- CPU DETECTION ------------------------------ //
+// ------------------------------------------------------------------------- //
+
+// Checks AVX2 and FMA support, including that the OS saves the AVX registers
+static bool supportsAVX2() {
+
+#if !defined(PARTICLE_KERNELS_AVX2)
+  // The AVX2 kernels are not part of this build
+  return false;
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  bool os_xsave = (info[2] & (1 << 27)) != 0;
+  bool avx = (info[2] & (1 << 28)) != 0;
+  bool fma = (info[2] & (1 << 12)) != 0;
+  if (!os_xsave || !avx || !fma) return false;
+  if ((_xgetbv(0) & 0x6) != 0x6) return false;
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+  return false;
+#endif
+
+}
+
+// ------------------------------------------------------------------------- //
+
+ParticleInstructionSet getParticleInstructionSet() {
+
+  // SSE is always available on x64
+  static const ParticleInstructionSet instruction_set = supportsAVX2() ?
+    kParticleInstructionSet_AVX2 : kParticleInstructionSet_SSE;
+
+  return instruction_set;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+// ------------------------------------------------------------------------- //
+// ----------------------------- UPDATE KERNEL ----------------------------- //
+// ------------------------------------------------------------------------- //
+
+// Sample of the curves for a normalized age, rounded to the nearest one and clamped to the curve
+static inline int curveSample(float age, float last_sample) {
+
+  return static_cast<int>(std::min(std::max(age * last_sample + 0.5f, 0.0f), last_sample));
+
+}
+
+// ------------------------------------------------------------------------- //
+
+template <class Lane>
+static inline typename Lane::Int curveSampleLanes(typename Lane::Float age,
+  typename Lane::Float last_sample) {
+
+  // Not fused so every instruction set picks the same sample as the scalar path
+  typename Lane::Float sample = Lane::add(Lane::mul(age, last_sample), Lane::set(0.5f));
+  sample = Lane::min(Lane::max(sample, Lane::set(0.0f)), last_sample);
+  return Lane::truncate(sample);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+// Squared distance added to the attractors distance, avoids infinite forces next to them
+static const float kAttractorSoftening = 0.01f;
+
+// ------------------------------------------------------------------------- //
+
+// Acceleration of a particle from gravity, wind, drag and the attractors
+static inline void forceAcceleration(const ParticleData& p, int i, const ParticleUpdateParams& params,
+  float* acceleration) {
+
+  float velocity[3] = { p.velocity_x_[i], p.velocity_y_[i], p.velocity_z_[i] };
+  float position[3] = { p.position_x_[i], p.position_y_[i], p.position_z_[i] };
+
+  // Drag opposes the velocity, the quadratic term grows with the speed
+  float speed = sqrtf(velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2]);
+  float drag = params.linear_drag + params.quadratic_drag * speed;
+  for (int c = 0; c < 3; ++c) {
+    acceleration[c] = params.acceleration[c] - drag * velocity[c];
+  }
+
+  // Inverse square falloff, the direction is normalized dividing by the distance once more
+  for (int a = 0; a < params.attractor_count; ++a) {
+    const ParticleAttractor& attractor = params.attractors[a];
+    float offset[3] = { attractor.position.x - position[0], attractor.position.y - position[1],
+      attractor.position.z - position[2] };
+    float distance_sq = offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2] + kAttractorSoftening;
+    if (distance_sq >= attractor.radius_sq) continue;
+
+    float inv_distance = 1.0f / sqrtf(distance_sq);
+    float force = attractor.strength * inv_distance * (inv_distance * inv_distance);
+    for (int c = 0; c < 3; ++c) {
+      acceleration[c] += force * offset[c];
+    }
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+template <class Lane>
+static inline void forceAccelerationLanes(const typename Lane::Float* velocity, const typename Lane::Float* position,
+  const ParticleUpdateParams& params, typename Lane::Float* acceleration) {
+
+  typedef typename Lane::Float Float;
+
+  Float speed_sq = Lane::mul(velocity[0], velocity[0]);
+  speed_sq = Lane::add(speed_sq, Lane::mul(velocity[1], velocity[1]));
+  speed_sq = Lane::add(speed_sq, Lane::mul(velocity[2], velocity[2]));
+  Float drag = Lane::add(Lane::set(params.linear_drag), Lane::mul(Lane::set(params.quadratic_drag), Lane::sqrt(speed_sq)));
+  for (int c = 0; c < 3; ++c) {
+    acceleration[c] = Lane::sub(Lane::set(params.acceleration[c]), Lane::mul(drag, velocity[c]));
+  }
+
+  for (int a = 0; a < params.attractor_count; ++a) {
+    const ParticleAttractor& attractor = params.attractors[a];
+    Float offset[3] = {
+      Lane::sub(Lane::set(attractor.position.x), position[0]),
+      Lane::sub(Lane::set(attractor.position.y), position[1]),
+      Lane::sub(Lane::set(attractor.position.z), position[2]),
+    };
+    Float distance_sq = Lane::mul(offset[0], offset[0]);
+    distance_sq = Lane::add(distance_sq, Lane::mul(offset[1], offset[1]));
+    distance_sq = Lane::add(distance_sq, Lane::mul(offset[2], offset[2]));
+    distance_sq = Lane::add(distance_sq, Lane::set(kAttractorSoftening));
+
+    Float inv_distance = Lane::div(Lane::set(1.0f), Lane::sqrt(distance_sq));
+    Float force = Lane::mul(Lane::mul(Lane::set(attractor.strength), inv_distance), Lane::mul(inv_distance, inv_distance));
+    // Particles out of the radius get no force
+    force = Lane::maskAnd(force, Lane::greater(Lane::set(attractor.radius_sq), distance_sq));
+    for (int c = 0; c < 3; ++c) {
+      acceleration[c] = Lane::add(acceleration[c], Lane::mul(force, offset[c]));
+    }
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+// Linear interpolation written the same way in every path
+static inline float lerpScalar(float a, float b, float t) {
+
+  return a + (b - a) * t;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+// Trilinear sample of a vector field at a particle position, scaled by the sampler strength
+static inline void sampleVectorField(const VectorFieldSampler& s, const float* position, float* result) {
+
+  float offset[3][2], weight[3];
+
+  for (int a = 0; a < 3; ++a) {
+    float g = s.to_grid[a][0] * position[0] + s.to_grid[a][1] * position[1] +
+      s.to_grid[a][2] * position[2] + s.to_grid[a][3];
+    float last = s.size[a] - 1.0f;
+
+    if (s.wrap) {
+      g = g - s.size[a] * truncf(g / s.size[a]);
+      if (0.0f > g) g += s.size[a];
+    }
+    else {
+      g = std::min(std::max(g, 0.0f), last);
+    }
+
+    float cell = truncf(g);
+    weight[a] = g - cell;
+    // Rounding may leave a wrapped coordinate right at the size
+    if (cell > last) cell -= s.size[a];
+
+    float next = cell + 1.0f;
+    if (next > last) next = s.wrap ? next - s.size[a] : last;
+
+    offset[a][0] = cell * s.stride[a];
+    offset[a][1] = next * s.stride[a];
+  }
+
+  for (int c = 0; c < 3; ++c) {
+    float corner[8];
+    for (int k = 0; k < 8; ++k) {
+      float index = offset[0][k & 1] + offset[1][(k >> 1) & 1] + offset[2][(k >> 2) & 1];
+      corner[k] = s.field[c][static_cast<int>(index)];
+    }
+    float y0 = lerpScalar(lerpScalar(corner[0], corner[1], weight[0]), lerpScalar(corner[2], corner[3], weight[0]), weight[1]);
+    float y1 = lerpScalar(lerpScalar(corner[4], corner[5], weight[0]), lerpScalar(corner[6], corner[7], weight[0]), weight[1]);
+    result[c] = lerpScalar(y0, y1, weight[2]) * s.strength;
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+template <class Lane>
+static inline typename Lane::Float lerpLanes(typename Lane::Float a, typename Lane::Float b,
+  typename Lane::Float t) {
+
+  return Lane::add(a, Lane::mul(Lane::sub(b, a), t));
+
+}
+
+// ------------------------------------------------------------------------- //
+
+template <class Lane>
+static inline void sampleVectorFieldLanes(const VectorFieldSampler& s, const typename Lane::Float* position,
+  typename Lane::Float* result) {
+
+  typedef typename Lane::Float Float;
+
+  const Float zero = Lane::set(0.0f);
+  Float offset[3][2], weight[3];
+
+  for (int a = 0; a < 3; ++a) {
+    Float g = Lane::mul(Lane::set(s.to_grid[a][0]), position[0]);
+    g = Lane::add(g, Lane::mul(Lane::set(s.to_grid[a][1]), position[1]));
+    g = Lane::add(g, Lane::mul(Lane::set(s.to_grid[a][2]), position[2]));
+    g = Lane::add(g, Lane::set(s.to_grid[a][3]));
+    const Float size = Lane::set(s.size[a]);
+    const Float last = Lane::set(s.size[a] - 1.0f);
+
+    if (s.wrap) {
+      g = Lane::sub(g, Lane::mul(size, Lane::toFloat(Lane::truncate(Lane::div(g, size)))));
+      g = Lane::add(g, Lane::maskAnd(size, Lane::greater(zero, g)));
+    }
+    else {
+      g = Lane::min(Lane::max(g, zero), last);
+    }
+
+    Float cell = Lane::toFloat(Lane::truncate(g));
+    weight[a] = Lane::sub(g, cell);
+    cell = Lane::sub(cell, Lane::maskAnd(size, Lane::greater(cell, last)));
+
+    Float next = Lane::add(cell, Lane::set(1.0f));
+    if (s.wrap) {
+      next = Lane::sub(next, Lane::maskAnd(size, Lane::greater(next, last)));
+    }
+    else {
+      next = Lane::min(next, last);
+    }
+
+    const Float stride = Lane::set(s.stride[a]);
+    offset[a][0] = Lane::mul(cell, stride);
+    offset[a][1] = Lane::mul(next, stride);
+  }
+
+  typename Lane::Int index[8];
+  for (int k = 0; k < 8; ++k) {
+    index[k] = Lane::truncate(Lane::add(Lane::add(offset[0][k & 1], offset[1][(k >> 1) & 1]), offset[2][(k >> 2) & 1]));
+  }
+
+  const Float strength = Lane::set(s.strength);
+  for (int c = 0; c < 3; ++c) {
+    Float corner[8];
+    for (int k = 0; k < 8; ++k) {
+      corner[k] = Lane::gather(s.field[c], index[k]);
+    }
+    Float y0 = lerpLanes<Lane>(lerpLanes<Lane>(corner[0], corner[1], weight[0]), lerpLanes<Lane>(corner[2], corner[3], weight[0]), weight[1]);
+    Float y1 = lerpLanes<Lane>(lerpLanes<Lane>(corner[4], corner[5], weight[0]), lerpLanes<Lane>(corner[6], corner[7], weight[0]), weight[1]);
+    result[c] = Lane::mul(lerpLanes<Lane>(y0, y1, weight[2]), strength);
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+// Updates a single particle, used by the scalar kernel and the vector kernels remainder
+template <int kModules>
+static inline bool updateParticle(ParticleData& p, int i, const ParticleUpdateParams& params) {
+
+  float age = p.life_time_[i] * params.inv_max_life_time;
+  int sample = curveSample(age, params.curve_last_sample);
+
+  //Update color
+  if (kModules & kParticleUpdateModule_LerpColor) {
+    p.color_r_[i] = params.color_curve[0][sample];
+    p.color_g_[i] = params.color_curve[1][sample];
+    p.color_b_[i] = params.color_curve[2][sample];
+    p.color_a_[i] = params.color_curve[3][sample];
+  }
+  if (kModules & kParticleUpdateModule_LerpAlpha) {
+    p.color_a_[i] = params.alpha_curve[sample];
+  }
+
+  //Update speed
+  if (kModules & kParticleUpdateModule_LerpSpeed) {
+    p.velocity_x_[i] = params.velocity_curve[0][sample];
+    p.velocity_y_[i] = params.velocity_curve[1][sample];
+    p.velocity_z_[i] = params.velocity_curve[2][sample];
+  }
+
+  //Accumulate the forces into the velocity before moving
+  if (kModules & kParticleUpdateModule_Forces) {
+    float acceleration[3];
+    forceAcceleration(p, i, params, acceleration);
+    p.velocity_x_[i] += acceleration[0] * params.delta_time;
+    p.velocity_y_[i] += acceleration[1] * params.delta_time;
+    p.velocity_z_[i] += acceleration[2] * params.delta_time;
+  }
+
+  //Force fields accelerate the particles, velocity fields move them without changing their velocity
+  float motion[3] = { p.velocity_x_[i], p.velocity_y_[i], p.velocity_z_[i] };
+  if (kModules & kParticleUpdateModule_VectorFields) {
+    float position[3] = { p.position_x_[i], p.position_y_[i], p.position_z_[i] };
+    float* velocity[3] = { p.velocity_x_, p.velocity_y_, p.velocity_z_ };
+    float field_motion[3] = { 0.0f, 0.0f, 0.0f };
+    for (int f = 0; f < params.vector_field_count; ++f) {
+      const VectorFieldSampler& field = params.vector_fields[f];
+      float field_value[3];
+      sampleVectorField(field, position, field_value);
+      for (int c = 0; c < 3; ++c) {
+        if (field.force) {
+          velocity[c][i] += field_value[c] * params.delta_time;
+        }
+        else {
+          field_motion[c] += field_value[c];
+        }
+      }
+    }
+    for (int c = 0; c < 3; ++c) {
+      motion[c] = velocity[c][i] + field_motion[c];
+    }
+  }
+
+  //Update position and life time, keeping the previous position for the render interpolation
+  p.life_time_[i] += params.delta_time;
+  p.previous_position_x_[i] = p.position_x_[i];
+  p.previous_position_y_[i] = p.position_y_[i];
+  p.previous_position_z_[i] = p.position_z_[i];
+  p.position_x_[i] += motion[0] * params.delta_time;
+  p.position_y_[i] += motion[1] * params.delta_time;
+  p.position_z_[i] += motion[2] * params.delta_time;
+
+  return params.max_life_time > 0.0f && p.life_time_[i] > params.max_life_time;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+template <class Lane, int kModules>
+static int updateParticlesLanes(ParticleData& p, int begin, int end, const ParticleUpdateParams& params) {
+
+  typedef typename Lane::Float Float;
+
+  const Float dt = Lane::set(params.delta_time);
+  const Float max_life = Lane::set(params.max_life_time);
+  const Float inv_max_life = Lane::set(params.inv_max_life_time);
+  // All bits set when particles can die, it masks the death comparison
+  const Float can_die = Lane::greater(max_life, Lane::set(0.0f));
+
+  const Float last_sample = Lane::set(params.curve_last_sample);
+
+  float* color[4] = { p.color_r_, p.color_g_, p.color_b_, p.color_a_ };
+  float* velocity[3] = { p.velocity_x_, p.velocity_y_, p.velocity_z_ };
+  float* position[3] = { p.position_x_, p.position_y_, p.position_z_ };
+  float* previous_position[3] = { p.previous_position_x_, p.previous_position_y_, p.previous_position_z_ };
+
+  int dead_particles = 0;
+  int vector_end = begin + ((end - begin) / Lane::kWidth) * Lane::kWidth;
+
+  for (int i = begin; i < vector_end; i += Lane::kWidth) {
+    Float life = Lane::load(p.life_time_ + i);
+    typename Lane::Int sample = curveSampleLanes<Lane>(Lane::mul(life, inv_max_life), last_sample);
+
+    if (kModules & kParticleUpdateModule_LerpColor) {
+      for (int c = 0; c < 4; ++c) {
+        Lane::store(color[c] + i, Lane::gather(params.color_curve[c], sample));
+      }
+    }
+    if (kModules & kParticleUpdateModule_LerpAlpha) {
+      Lane::store(color[3] + i, Lane::gather(params.alpha_curve, sample));
+    }
+
+    if (kModules & kParticleUpdateModule_LerpSpeed) {
+      for (int c = 0; c < 3; ++c) {
+        Lane::store(velocity[c] + i, Lane::gather(params.velocity_curve[c], sample));
+      }
+    }
+
+    Float vel[3], pos[3];
+    for (int c = 0; c < 3; ++c) {
+      vel[c] = Lane::load(velocity[c] + i);
+      pos[c] = Lane::load(position[c] + i);
+    }
+
+    if (kModules & kParticleUpdateModule_Forces) {
+      Float acceleration[3];
+      forceAccelerationLanes<Lane>(vel, pos, params, acceleration);
+      for (int c = 0; c < 3; ++c) {
+        vel[c] = Lane::mulAdd(acceleration[c], dt, vel[c]);
+        Lane::store(velocity[c] + i, vel[c]);
+      }
+    }
+
+    if (kModules & kParticleUpdateModule_VectorFields) {
+      Float field_motion[3] = { Lane::set(0.0f), Lane::set(0.0f), Lane::set(0.0f) };
+      for (int f = 0; f < params.vector_field_count; ++f) {
+        const VectorFieldSampler& field = params.vector_fields[f];
+        Float field_value[3];
+        sampleVectorFieldLanes<Lane>(field, pos, field_value);
+        for (int c = 0; c < 3; ++c) {
+          if (field.force) {
+            vel[c] = Lane::mulAdd(field_value[c], dt, vel[c]);
+          }
+          else {
+            field_motion[c] = Lane::add(field_motion[c], field_value[c]);
+          }
+        }
+      }
+      for (int c = 0; c < 3; ++c) {
+        Lane::store(velocity[c] + i, vel[c]);
+        vel[c] = Lane::add(vel[c], field_motion[c]);
+      }
+    }
+
+    for (int c = 0; c < 3; ++c) {
+      Lane::store(previous_position[c] + i, pos[c]);
+      Lane::store(position[c] + i, Lane::mulAdd(vel[c], dt, pos[c]));
+    }
+
+    life = Lane::add(life, dt);
+    Lane::store(p.life_time_ + i, life);
+    dead_particles += Lane::maskCount(Lane::maskAnd(Lane::greater(life, max_life), can_die));
+  }
+
+  for (int i = vector_end; i < end; ++i) {
+    if (updateParticle<kModules>(p, i, params)) ++dead_particles;
+  }
+
+  return dead_particles;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+template <int kModules>
+static int updateParticlesScalar(ParticleData& particles, int begin, int end, const ParticleUpdateParams& params) {
+
+  int dead_particles = 0;
+
+  for (int i = begin; i < end; ++i) {
+    if (updateParticle<kModules>(particles, i, params)) ++dead_particles;
+  }
+
+  return dead_particles;
+
+}
+
+// ------------------------------------------------------------------------- //
+// ---------------------------- COLLISION KERNEL --------------------------- //
+// ------------------------------------------------------------------------- //
+
+// Moves a penetrating particle back to the surface and reflects its velocity if it moves into it
+// The normal points out of the collider and distance is negative inside it
+static inline void collisionResponse(float* position, float* velocity, const float* normal, float distance,
+  const ParticleUpdateParams& params) {
+
+  for (int c = 0; c < 3; ++c) {
+    position[c] -= normal[c] * distance;
+  }
+
+  float normal_speed = velocity[0] * normal[0] + velocity[1] * normal[1] + velocity[2] * normal[2];
+  if (normal_speed >= 0.0f) return;
+
+  // Normal part bounces back, the tangent part loses the friction
+  for (int c = 0; c < 3; ++c) {
+    float normal_velocity = normal[c] * normal_speed;
+    float tangent_velocity = velocity[c] - normal_velocity;
+    velocity[c] = tangent_velocity * (1.0f - params.collision_friction) - normal_velocity * params.collision_bounce;
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+// Outward normal and signed distance of a particle to a collider
+static inline void colliderDistance(const ParticleCollider& collider, const float* position,
+  float* normal, float* distance) {
+
+  switch (collider.shape) {
+  case ParticleCollider::kShape_Plane: {
+    for (int c = 0; c < 3; ++c) {
+      normal[c] = collider.normal[c];
+    }
+    *distance = collider.normal.x * position[0] + collider.normal.y * position[1] +
+      collider.normal.z * position[2] - collider.distance;
+    break;
+  }
+  case ParticleCollider::kShape_Sphere: {
+    float offset[3] = { position[0] - collider.center.x, position[1] - collider.center.y, position[2] - collider.center.z };
+    float length = std::max(sqrtf(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]), 1e-6f);
+    // Containers keep the particles inside, their normal points to the center
+    float inv_length = collider.side / length;
+    for (int c = 0; c < 3; ++c) {
+      normal[c] = offset[c] * inv_length;
+    }
+    *distance = collider.side * (length - collider.radius);
+    break;
+  }
+  default: {
+    // Particles inside a box leave through the closest face
+    float min_penetration = FLT_MAX;
+    for (int c = 0; c < 3; ++c) {
+      float to_min = position[c] - collider.box_min[c];
+      float to_max = collider.box_max[c] - position[c];
+      float penetration = std::min(to_min, to_max);
+      normal[c] = 0.0f;
+      if (penetration < min_penetration) {
+        min_penetration = penetration;
+        for (int n = 0; n < c; ++n) normal[n] = 0.0f;
+        normal[c] = to_min < to_max ? -1.0f : 1.0f;
+      }
+    }
+    *distance = -min_penetration;
+    break;
+  }
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+static int collideParticlesScalar(ParticleData& p, int begin, int end, const ParticleUpdateParams& params) {
+
+  int killed_particles = 0;
+  float* position[3] = { p.position_x_, p.position_y_, p.position_z_ };
+  float* velocity[3] = { p.velocity_x_, p.velocity_y_, p.velocity_z_ };
+
+  for (int k = 0; k < params.collider_count; ++k) {
+    const ParticleCollider& collider = params.colliders[k];
+    for (int i = begin; i < end; ++i) {
+      float pos[3] = { position[0][i], position[1][i], position[2][i] };
+      float normal[3], distance;
+      colliderDistance(collider, pos, normal, &distance);
+      if (!(distance < 0.0f)) continue;
+
+      if (params.collision_flags != nullptr) params.collision_flags[i] = 1;
+      if (params.collision_kill) {
+        if (p.life_time_[i] != kParticleKilledLifeTime) ++killed_particles;
+        p.life_time_[i] = kParticleKilledLifeTime;
+        continue;
+      }
+
+      float vel[3] = { velocity[0][i], velocity[1][i], velocity[2][i] };
+      collisionResponse(pos, vel, normal, distance, params);
+      for (int c = 0; c < 3; ++c) {
+        position[c][i] = pos[c];
+        velocity[c][i] = vel[c];
+      }
+    }
+  }
+
+  return killed_particles;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+template <class Lane>
+static inline void colliderDistanceLanes(const ParticleCollider& collider, const typename Lane::Float* position,
+  typename Lane::Float* normal, typename Lane::Float* distance) {
+
+  typedef typename Lane::Float Float;
+
+  switch (collider.shape) {
+  case ParticleCollider::kShape_Plane: {
+    for (int c = 0; c < 3; ++c) {
+      normal[c] = Lane::set(collider.normal[c]);
+    }
+    Float d = Lane::mul(normal[0], position[0]);
+    d = Lane::add(d, Lane::mul(normal[1], position[1]));
+    d = Lane::add(d, Lane::mul(normal[2], position[2]));
+    *distance = Lane::sub(d, Lane::set(collider.distance));
+    break;
+  }
+  case ParticleCollider::kShape_Sphere: {
+    Float offset[3];
+    for (int c = 0; c < 3; ++c) {
+      offset[c] = Lane::sub(position[c], Lane::set(collider.center[c]));
+    }
+    Float length_sq = Lane::mul(offset[0], offset[0]);
+    length_sq = Lane::add(length_sq, Lane::mul(offset[1], offset[1]));
+    length_sq = Lane::add(length_sq, Lane::mul(offset[2], offset[2]));
+    Float length = Lane::max(Lane::sqrt(length_sq), Lane::set(1e-6f));
+    Float inv_length = Lane::div(Lane::set(collider.side), length);
+    for (int c = 0; c < 3; ++c) {
+      normal[c] = Lane::mul(offset[c], inv_length);
+    }
+    *distance = Lane::mul(Lane::set(collider.side), Lane::sub(length, Lane::set(collider.radius)));
+    break;
+  }
+  default: {
+    Float min_penetration = Lane::set(FLT_MAX);
+    for (int c = 0; c < 3; ++c) {
+      Float to_min = Lane::sub(position[c], Lane::set(collider.box_min[c]));
+      Float to_max = Lane::sub(Lane::set(collider.box_max[c]), position[c]);
+      Float penetration = Lane::min(to_min, to_max);
+      Float side = Lane::select(Lane::greater(to_max, to_min), Lane::set(-1.0f), Lane::set(1.0f));
+      // A closer face replaces the normal of the previous axes
+      Float closer = Lane::greater(min_penetration, penetration);
+      for (int n = 0; n < c; ++n) {
+        normal[n] = Lane::select(closer, Lane::set(0.0f), normal[n]);
+      }
+      normal[c] = Lane::maskAnd(closer, side);
+      min_penetration = Lane::min(min_penetration, penetration);
+    }
+    *distance = Lane::sub(Lane::set(0.0f), min_penetration);
+    break;
+  }
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+template <class Lane>
+static int collideParticlesLanes(ParticleData& p, int begin, int end, const ParticleUpdateParams& params) {
+
+  typedef typename Lane::Float Float;
+
+  const Float zero = Lane::set(0.0f);
+  const Float killed_life = Lane::set(kParticleKilledLifeTime);
+  const Float friction = Lane::set(1.0f - params.collision_friction);
+  const Float bounce = Lane::set(params.collision_bounce);
+
+  float* position[3] = { p.position_x_, p.position_y_, p.position_z_ };
+  float* velocity[3] = { p.velocity_x_, p.velocity_y_, p.velocity_z_ };
+
+  int killed_particles = 0;
+  int vector_end = begin + ((end - begin) / Lane::kWidth) * Lane::kWidth;
+
+  // One pass per collider keeps the collider values in registers
+  for (int k = 0; k < params.collider_count; ++k) {
+    const ParticleCollider& collider = params.colliders[k];
+
+    for (int i = begin; i < vector_end; i += Lane::kWidth) {
+      Float pos[3];
+      for (int c = 0; c < 3; ++c) {
+        pos[c] = Lane::load(position[c] + i);
+      }
+      Float normal[3], distance;
+      colliderDistanceLanes<Lane>(collider, pos, normal, &distance);
+
+      Float colliding = Lane::greater(zero, distance);
+      int colliding_lanes = Lane::maskBits(colliding);
+      if (colliding_lanes == 0) continue;
+
+      if (params.collision_flags != nullptr) {
+        for (int l = 0; l < Lane::kWidth; ++l) {
+          if (colliding_lanes & (1 << l)) params.collision_flags[i + l] = 1;
+        }
+      }
+
+      if (params.collision_kill) {
+        Float life = Lane::load(p.life_time_ + i);
+        killed_particles += Lane::maskCount(Lane::maskAnd(colliding, Lane::greater(life, killed_life)));
+        Lane::store(p.life_time_ + i, Lane::select(colliding, killed_life, life));
+        continue;
+      }
+
+      Float vel[3];
+      for (int c = 0; c < 3; ++c) {
+        vel[c] = Lane::load(velocity[c] + i);
+      }
+      Float normal_speed = Lane::mul(vel[0], normal[0]);
+      normal_speed = Lane::add(normal_speed, Lane::mul(vel[1], normal[1]));
+      normal_speed = Lane::add(normal_speed, Lane::mul(vel[2], normal[2]));
+      Float approaching = Lane::maskAnd(colliding, Lane::greater(zero, normal_speed));
+
+      for (int c = 0; c < 3; ++c) {
+        Float pushed = Lane::sub(pos[c], Lane::mul(normal[c], distance));
+        Lane::store(position[c] + i, Lane::select(colliding, pushed, pos[c]));
+
+        Float normal_velocity = Lane::mul(normal[c], normal_speed);
+        Float tangent_velocity = Lane::sub(vel[c], normal_velocity);
+        Float bounced = Lane::sub(Lane::mul(tangent_velocity, friction), Lane::mul(normal_velocity, bounce));
+        Lane::store(velocity[c] + i, Lane::select(approaching, bounced, vel[c]));
+      }
+    }
+  }
+
+  // The remainder goes through every collider at once
+  killed_particles += collideParticlesScalar(p, vector_end, end, params);
+
+  return killed_particles;
+
+}
+
+static void gravityScalar(const float* const target[3], int target_count,
+  const float* const source[4], int source_count, float softening_sq, float* const acceleration[3]) {
+
+  for (int t = 0; t < target_count; ++t) {
+    float a[3] = { 0.0f, 0.0f, 0.0f };
+    for (int s = 0; s < source_count; ++s) {
+      float dx = source[0][s] - target[0][t];
+      float dy = source[1][s] - target[1][t];
+      float dz = source[2][s] - target[2][t];
+      float distance_sq = dx * dx + dy * dy + dz * dz + softening_sq;
+      // A target is also a source, without softening it has no distance to itself
+      if (distance_sq <= 0.0f) continue;
+      float inv_distance = 1.0f / sqrtf(distance_sq);
+      float strength = source[3][s] * inv_distance * inv_distance * inv_distance;
+      a[0] += dx * strength;
+      a[1] += dy * strength;
+      a[2] += dz * strength;
+    }
+    for (int c = 0; c < 3; ++c) {
+      acceleration[c][t] += a[c];
+    }
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+// One target per lane, every source is broadcast to all of them
+template <class Lane>
+static void gravityLanes(const float* const target[3], int target_count,
+  const float* const source[4], int source_count, float softening_sq, float* const acceleration[3]) {
+
+  typedef typename Lane::Float Float;
+  const Float zero = Lane::set(0.0f);
+  const Float softening = Lane::set(softening_sq);
+
+  for (int t = 0; t < target_count; t += Lane::kWidth) {
+    Float px = Lane::load(target[0] + t);
+    Float py = Lane::load(target[1] + t);
+    Float pz = Lane::load(target[2] + t);
+    Float ax = zero, ay = zero, az = zero;
+
+    for (int s = 0; s < source_count; ++s) {
+      Float dx = Lane::sub(Lane::set(source[0][s]), px);
+      Float dy = Lane::sub(Lane::set(source[1][s]), py);
+      Float dz = Lane::sub(Lane::set(source[2][s]), pz);
+      Float distance_sq = Lane::mulAdd(dx, dx, Lane::mulAdd(dy, dy, Lane::mulAdd(dz, dz, softening)));
+      Float inv_distance = Lane::div(Lane::set(1.0f), Lane::sqrt(distance_sq));
+      inv_distance = Lane::select(Lane::greater(distance_sq, zero), inv_distance, zero);
+      Float strength = Lane::mul(Lane::set(source[3][s]), Lane::mul(inv_distance, Lane::mul(inv_distance, inv_distance)));
+      ax = Lane::mulAdd(dx, strength, ax);
+      ay = Lane::mulAdd(dy, strength, ay);
+      az = Lane::mulAdd(dz, strength, az);
+    }
+
+    Lane::store(acceleration[0] + t, Lane::add(Lane::load(acceleration[0] + t), ax));
+    Lane::store(acceleration[1] + t, Lane::add(Lane::load(acceleration[1] + t), ay));
+    Lane::store(acceleration[2] + t, Lane::add(Lane::load(acceleration[2] + t), az));
+  }
+
+}
+
+static void sortKeysScalar(ParticleData& p, int begin, int end, const float to_camera[3][4]) {
+
+  for (int i = begin; i < end; ++i) {
+    float distance_sq = 0.0f;
+    for (int r = 0; r < 3; ++r) {
+      float offset = to_camera[r][0] * p.position_x_[i] + to_camera[r][1] * p.position_y_[i] +
+        to_camera[r][2] * p.position_z_[i] + to_camera[r][3];
+      distance_sq += offset * offset;
+    }
+    p.sort_key_[i] = distance_sq;
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+template <class Lane>
+static void sortKeysLanes(ParticleData& p, int begin, int end, const float to_camera[3][4]) {
+
+  typedef typename Lane::Float Float;
+
+  Float matrix[3][4];
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      matrix[r][c] = Lane::set(to_camera[r][c]);
+    }
+  }
+
+  int vector_end = begin + ((end - begin) / Lane::kWidth) * Lane::kWidth;
+  for (int i = begin; i < vector_end; i += Lane::kWidth) {
+    Float x = Lane::load(p.position_x_ + i);
+    Float y = Lane::load(p.position_y_ + i);
+    Float z = Lane::load(p.position_z_ + i);
+    Float distance_sq = Lane::set(0.0f);
+    for (int r = 0; r < 3; ++r) {
+      Float offset = Lane::mulAdd(matrix[r][0], x, Lane::mulAdd(matrix[r][1], y, Lane::mulAdd(matrix[r][2], z, matrix[r][3])));
+      distance_sq = Lane::mulAdd(offset, offset, distance_sq);
+    }
+    Lane::store(p.sort_key_ + i, distance_sq);
+  }
+
+  sortKeysScalar(p, vector_end, end, to_camera);
+
+}
+
+// ------------------------------------------------------------------------- //
+// ----------------------------- KERNEL TABLE ------------------------------ //
+// ------------------------------------------------------------------------- //
+
+// Kernels of every instruction set for a module combination
+template <int kModules>
+struct ParticleKernelSet {
+  static int scalar(ParticleData& p, int begin, int end, const ParticleUpdateParams& params) {
+    return updateParticlesScalar<kModules>(p, begin, end, params);
+  }
+  static int sse(ParticleData& p, int begin, int end, const ParticleUpdateParams& params) {
+    return updateParticlesLanes<LaneSSE, kModules>(p, begin, end, params);
+  }
+#ifdef PARTICLE_KERNELS_AVX2
+  static int avx2(ParticleData& p, int begin, int end, const ParticleUpdateParams& params) {
+    return updateParticlesLanes<LaneAVX2, kModules>(p, begin, end, params);
+  }
+#else
+  static int avx2(ParticleData& p, int begin, int end, const ParticleUpdateParams& params) {
+    return sse(p, begin, end, params);
+  }
+#endif
+};
+
+// Fills the kernels of every module combination up to kModules
+template <int kModules>
+struct ParticleKernelTable {
+  static void fill(ParticleUpdateKernel (*table)[3]) {
+    table[kModules][kParticleInstructionSet_Scalar] = ParticleKernelSet<kModules>::scalar;
+    table[kModules][kParticleInstructionSet_SSE] = ParticleKernelSet<kModules>::sse;
+    table[kModules][kParticleInstructionSet_AVX2] = ParticleKernelSet<kModules>::avx2;
+    ParticleKernelTable<kModules - 1>::fill(table);
+  }
+};
+
+template <>
+struct ParticleKernelTable<-1> {
+  static void fill(ParticleUpdateKernel (*)[3]) {}
+};
+
+// ------------------------------------------------------------------------- //
+
+// Indexed by [modules][instruction set]
+struct ParticleKernelTableInstance {
+  ParticleKernelTableInstance() {
+    ParticleKernelTable<kParticleUpdateModule_Combinations - 1>::fill(kernels);
+  }
+  ParticleUpdateKernel kernels[kParticleUpdateModule_Combinations][3];
+};
+
+// ------------------------------------------------------------------------- //
+
+ParticleUpdateKernel getParticleUpdateKernel(ParticleInstructionSet instruction_set, int modules) {
+
+  // Never return a kernel the CPU can't execute
+  if (instruction_set > getParticleInstructionSet()) {
+    instruction_set = getParticleInstructionSet();
+  }
+  modules &= kParticleUpdateModule_Combinations - 1;
+
+  static const ParticleKernelTableInstance table;
+  return table.kernels[modules][instruction_set];
+
+}
+
+// ------------------------------------------------------------------------- //
+
+ParticleCollisionKernel getParticleCollisionKernel(ParticleInstructionSet instruction_set) {
+
+  if (instruction_set > getParticleInstructionSet()) {
+    instruction_set = getParticleInstructionSet();
+  }
+
+  switch (instruction_set) {
+#ifdef PARTICLE_KERNELS_AVX2
+  case kParticleInstructionSet_AVX2: return collideParticlesLanes<LaneAVX2>;
+#endif
+  case kParticleInstructionSet_SSE: return collideParticlesLanes<LaneSSE>;
+  default: return collideParticlesScalar;
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+ParticleGravityKernel getParticleGravityKernel(ParticleInstructionSet instruction_set) {
+
+  if (instruction_set > getParticleInstructionSet()) {
+    instruction_set = getParticleInstructionSet();
+  }
+
+  switch (instruction_set) {
+#ifdef PARTICLE_KERNELS_AVX2
+  case kParticleInstructionSet_AVX2: return gravityLanes<LaneAVX2>;
+#endif
+  case kParticleInstructionSet_SSE: return gravityLanes<LaneSSE>;
+  default: return gravityScalar;
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+ParticleSortKeyKernel getParticleSortKeyKernel(ParticleInstructionSet instruction_set) {
+
+  if (instruction_set > getParticleInstructionSet()) {
+    instruction_set = getParticleInstructionSet();
+  }
+
+  switch (instruction_set) {
+#ifdef PARTICLE_KERNELS_AVX2
+  case kParticleInstructionSet_AVX2: return sortKeysLanes<LaneAVX2>;
+#endif
+  case kParticleInstructionSet_SSE: return sortKeysLanes<LaneSSE>;
+  default: return sortKeysScalar;
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
@@ -0,0 +1,121 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+#ifndef __INTERNAL_PARTICLE_KERNELS_H__
+#define __INTERNAL_PARTICLE_KERNELS_H__
+
+// ------------------------------------------------------------------------- //
+
+#include "../src/engine_internal/internal_vector_field.h"
+
+// ------------------------------------------------------------------------- //
+
+struct ParticleData;
+struct ParticleAttractor;
+struct ParticleCollider;
+
+// ------------------------------------------------------------------------- //
+
+// Instruction sets that the particle kernels can use, selected at runtime by CPU features
+enum ParticleInstructionSet {
+  kParticleInstructionSet_Scalar = 0,
+  kParticleInstructionSet_SSE = 1,
+  kParticleInstructionSet_AVX2 = 2,
+};
+
+// ------------------------------------------------------------------------- //
+
+// Optional modules of the update, each combination has its own kernel so the inner loop has no module branches
+enum ParticleUpdateModule {
+  kParticleUpdateModule_None = 0,
+  kParticleUpdateModule_LerpColor = 1 << 0,
+  kParticleUpdateModule_LerpAlpha = 1 << 1,
+  kParticleUpdateModule_LerpSpeed = 1 << 2,
+  kParticleUpdateModule_Forces = 1 << 3,
+  kParticleUpdateModule_VectorFields = 1 << 4,
+  // Number of module combinations
+  kParticleUpdateModule_Combinations = 1 << 5,
+};
+
+// ------------------------------------------------------------------------- //
+
+// Values used by the update kernels, precomputed once per update to keep the inner loop simple
+struct ParticleUpdateParams {
+  float delta_time;
+  // Particles die when their life time is greater than it, 0 means they never die
+  float max_life_time;
+  // Multiplier to normalize the life time for the over lifetime lerps
+  float inv_max_life_time;
+
+  // Over lifetime curves baked in lookup tables, sampled with the normalized age times the last sample index
+  float curve_last_sample;
+  const float* color_curve[4];
+  const float* alpha_curve;
+  const float* velocity_curve[3];
+
+  // Forces accumulated into the velocity, gravity and wind are added as a single acceleration
+  float acceleration[3];
+  float linear_drag;
+  float quadratic_drag;
+  int attractor_count;
+  const ParticleAttractor* attractors;
+
+  // Vector fields sampled at the particles position, they accelerate them or add their velocity when moving
+  static const int kMaxVectorFields = 2;
+  int vector_field_count;
+  VectorFieldSampler vector_fields[kMaxVectorFields];
+
+  // Colliders tested after moving the particles, with the response shared by all of them
+  int collider_count;
+  const ParticleCollider* colliders;
+  float collision_bounce;
+  float collision_friction;
+  bool collision_kill;
+  // Optional, set to 1 for the particles that touch a collider, indexed like the particles
+  unsigned char* collision_flags;
+};
+
+// Life time given to the particles killed before their time, removed with the dead ones
+static const float kParticleKilledLifeTime = -1.0f;
+
+// ------------------------------------------------------------------------- //
+
+// Advances the particles in [begin, end) lifetime, lerps and integration
+// Returns the number of particles that exceeded their life time, they must be removed after
+typedef int (*ParticleUpdateKernel)(ParticleData& particles, int begin, int end,
+  const ParticleUpdateParams& params);
+
+// Returns the best instruction set supported by the CPU, detected only once
+ParticleInstructionSet getParticleInstructionSet();
+
+// Pushes the particles in [begin, end) out of the colliders, with one pass per collider
+// Returns the number of particles killed by the collisions, they must be removed after
+typedef int (*ParticleCollisionKernel)(ParticleData& particles, int begin, int end,
+  const ParticleUpdateParams& params);
+
+// Adds to the accelerations of the targets the gravity of the sources (x, y, z and mass arrays)
+// The targets count must be a multiple of 8, softening_sq avoids infinite accelerations between close particles
+typedef void (*ParticleGravityKernel)(const float* const target[3], int target_count,
+  const float* const source[4], int source_count, float softening_sq, float* const acceleration[3]);
+
+// Writes the squared distance to the camera of the particles in [begin, end) to their sort key
+// to_camera (3x4, row major) maps the system space positions to offsets from the camera in world space
+typedef void (*ParticleSortKeyKernel)(ParticleData& particles, int begin, int end, const float to_camera[3][4]);
+
+// Returns the update kernel for the instruction set specialized for the enabled modules (ParticleUpdateModule flags)
+// Falls back to a supported instruction set, AVX2 results only differ by the fused multiply-add rounding
+ParticleUpdateKernel getParticleUpdateKernel(ParticleInstructionSet instruction_set, int modules);
+
+// Returns the collision kernel for the instruction set, falls back to a supported one
+ParticleCollisionKernel getParticleCollisionKernel(ParticleInstructionSet instruction_set);
+
+// Returns the gravity kernel for the instruction set, falls back to a supported one
+ParticleGravityKernel getParticleGravityKernel(ParticleInstructionSet instruction_set);
+
+// Returns the sort key kernel for the instruction set, falls back to a supported one
+ParticleSortKeyKernel getParticleSortKeyKernel(ParticleInstructionSet instruction_set);
+
+// ------------------------------------------------------------------------- //
+
+#endif // __INTERNAL_PARTICLE_KERNELS_H__
@@ -0,0 +1,147 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+// ------------------------------------------------------------------------- //
+
+#include "../src/engine_internal/internal_radix_sort.h"
+#include "engine/job_system.h"
+
+#include <algorithm>
+#include <cstring>
+
+// ------------------------------------------------------------------------- //
+
+// Keys handled by each block, big enough to make the counts of every block worth it
+static const int kRadixBlockSize = 16384;
+
+// ------------------------------------------------------------------------- //
+
+// Runs the function for every block of [0, count), serially without worker threads
+// The counts are indexed by block, so every call covers exactly one of them
+static void radixParallelFor(JobSystem* job_system, int count, int block_size,
+  const std::function<void(int begin, int end)>& function) {
+
+  if (job_system != nullptr && job_system->getThreadCount() > 1) {
+    job_system->parallelFor(count, block_size, function);
+    return;
+  }
+
+  for (int begin = 0; begin < count; begin += block_size) {
+    function(begin, std::min(begin + block_size, count));
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+RadixSorter::RadixSorter() {
+
+}
+
+// ------------------------------------------------------------------------- //
+
+RadixSorter::~RadixSorter() {
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void RadixSorter::sortFloatKeys(const float* keys, int count, bool descending, uint32_t* order,
+  JobSystem* job_system) {
+
+  if (count <= 0) return;
+
+  // Without worker threads a single block saves counting the digits again in every pass
+  const bool threaded = job_system != nullptr && job_system->getThreadCount() > 1;
+  const int block_size = threaded ? kRadixBlockSize : count;
+  const int blocks = (count + block_size - 1) / block_size;
+  for (int b = 0; b < 2; ++b) {
+    keys_[b].resize(count);
+    indices_[b].resize(count);
+  }
+  block_offsets_.resize(kPasses * blocks * kDigits);
+
+  // Positive floats order like their bits as integers, inverting them reverses the order
+  // The digits of every pass are counted while reading the keys, the counts of the later passes
+  // are only right for a single block, the others are counted again once the previous pass moved their keys
+  const uint32_t flip = descending ? 0xFFFFFFFFu : 0u;
+  radixParallelFor(job_system, count, block_size, [this, keys, flip, blocks, block_size](int begin, int end) {
+    uint32_t* counts[kPasses];
+    for (int pass = 0; pass < kPasses; ++pass) {
+      counts[pass] = block_offsets_.data() + (pass * blocks + begin / block_size) * kDigits;
+      memset(counts[pass], 0, kDigits * sizeof(uint32_t));
+    }
+    uint32_t* sort_keys = keys_[0].data();
+    uint32_t* indices = indices_[0].data();
+    for (int i = begin; i < end; ++i) {
+      uint32_t bits;
+      memcpy(&bits, keys + i, sizeof(bits));
+      bits ^= flip;
+      sort_keys[i] = bits;
+      indices[i] = static_cast<uint32_t>(i);
+      for (int pass = 0; pass < kPasses; ++pass) {
+        ++counts[pass][(bits >> (pass * kDigitBits)) & (kDigits - 1)];
+      }
+    }
+  });
+
+  int source = 0;
+  for (int pass = 0; pass < kPasses; ++pass) {
+    const int shift = pass * kDigitBits;
+    uint32_t* pass_offsets = block_offsets_.data() + pass * blocks * kDigits;
+
+    if (pass > 0 && blocks > 1) {
+      radixParallelFor(job_system, count, block_size, [this, source, shift, pass_offsets, block_size](int begin, int end) {
+        uint32_t* counts = pass_offsets + (begin / block_size) * kDigits;
+        memset(counts, 0, kDigits * sizeof(uint32_t));
+        const uint32_t* sort_keys = keys_[source].data();
+        for (int i = begin; i < end; ++i) {
+          ++counts[(sort_keys[i] >> shift) & (kDigits - 1)];
+        }
+      });
+    }
+
+    // Passes where all the keys have the same digit don't change the order
+    bool skip_pass = false;
+    for (int digit = 0; digit < kDigits && !skip_pass; ++digit) {
+      uint32_t digit_count = 0;
+      for (int block = 0; block < blocks; ++block) {
+        digit_count += pass_offsets[block * kDigits + digit];
+      }
+      skip_pass = digit_count == static_cast<uint32_t>(count);
+    }
+    if (skip_pass) continue;
+
+    // Offsets ordered by digit and then by block, that keeps the sort stable
+    uint32_t offset = 0;
+    for (int digit = 0; digit < kDigits; ++digit) {
+      for (int block = 0; block < blocks; ++block) {
+        uint32_t digit_count = pass_offsets[block * kDigits + digit];
+        pass_offsets[block * kDigits + digit] = offset;
+        offset += digit_count;
+      }
+    }
+
+    const int destination = source ^ 1;
+    radixParallelFor(job_system, count, block_size,
+      [this, source, destination, shift, pass_offsets, block_size](int begin, int end) {
+      uint32_t* offsets = pass_offsets + (begin / block_size) * kDigits;
+      const uint32_t* src_keys = keys_[source].data();
+      const uint32_t* src_indices = indices_[source].data();
+      uint32_t* dst_keys = keys_[destination].data();
+      uint32_t* dst_indices = indices_[destination].data();
+      for (int i = begin; i < end; ++i) {
+        uint32_t slot = offsets[(src_keys[i] >> shift) & (kDigits - 1)]++;
+        dst_keys[slot] = src_keys[i];
+        dst_indices[slot] = src_indices[i];
+      }
+    });
+    source = destination;
+  }
+
+  memcpy(order, indices_[source].data(), count * sizeof(uint32_t));
+
+}
+
+// ------------------------------------------------------------------------- //
@@ -0,0 +1,44 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+#ifndef __INTERNAL_RADIX_SORT_H__
+#define __INTERNAL_RADIX_SORT_H__
+
+// ------------------------------------------------------------------------- //
+
+#include <vector>
+#include <cstdint>
+
+class JobSystem;
+
+// ------------------------------------------------------------------------- //
+
+// Stable LSD radix sort of indices by 32 bit keys, 11 bits per pass so three passes cover them
+// The digits of all the passes are counted per block of keys in a single read, then every pass
+// scatters each block to the offsets its counts give it, so there are no atomics and equal keys keep their order
+class RadixSorter {
+public:
+  RadixSorter();
+  ~RadixSorter();
+
+  // Writes to order the indices [0, count) sorted by their float keys, which must not be negative
+  // Descending puts the greatest keys first. The work is split in the job system if there is one
+  void sortFloatKeys(const float* keys, int count, bool descending, uint32_t* order, JobSystem* job_system);
+
+private:
+  static const int kDigitBits = 11;
+  static const int kDigits = 1 << kDigitBits;
+  static const int kPasses = (32 + kDigitBits - 1) / kDigitBits;
+
+  // Keys and indices of the current pass and the ones being scattered
+  std::vector<uint32_t> keys_[2];
+  std::vector<uint32_t> indices_[2];
+  // Digit counts of every block, and then the offset where the block writes each digit, [pass][block][digit]
+  std::vector<uint32_t> block_offsets_;
+
+};
+
+// ------------------------------------------------------------------------- //
+
+#endif // __INTERNAL_RADIX_SORT_H__
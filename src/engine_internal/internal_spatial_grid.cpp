@@ -0,0 +1,143 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+// ------------------------------------------------------------------------- //
+
+#include "../src/engine_internal/internal_spatial_grid.h"
+#include "engine/job_system.h"
+
+#include <algorithm>
+
+// ------------------------------------------------------------------------- //
+
+// Elements processed by each job of the grid construction
+static const int kGridChunkSize = 8192;
+
+// ------------------------------------------------------------------------- //
+
+// Runs the function over [0, count) in chunks of kGridChunkSize, serially without worker threads
+// The prefix sum relies on every call covering exactly one chunk
+static void gridParallelFor(JobSystem* job_system, int count,
+  const std::function<void(int begin, int end)>& function) {
+
+  if (job_system != nullptr && job_system->getThreadCount() > 1) {
+    job_system->parallelFor(count, kGridChunkSize, function);
+    return;
+  }
+
+  for (int begin = 0; begin < count; begin += kGridChunkSize) {
+    function(begin, std::min(begin + kGridChunkSize, count));
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+SpatialHashGrid::SpatialHashGrid() {
+
+  count_ = 0;
+  inv_cell_size_ = 1.0f;
+  bucket_mask_ = 0;
+  bucket_capacity_ = 0;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+SpatialHashGrid::~SpatialHashGrid() {
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void SpatialHashGrid::build(const float* x, const float* y, const float* z, int count, float cell_size,
+  JobSystem* job_system) {
+
+  count_ = count;
+  inv_cell_size_ = 1.0f / cell_size;
+
+  // Around two buckets per particle keeps the collisions between cells low
+  int buckets = 1;
+  while (buckets < count * 2) buckets <<= 1;
+  bucket_mask_ = static_cast<uint32_t>(buckets - 1);
+
+  if (buckets > bucket_capacity_) {
+    bucket_count_.reset(new std::atomic<int>[buckets]);
+    bucket_capacity_ = buckets;
+  }
+  bucket_start_.resize(buckets + 1);
+  particle_buckets_.resize(count);
+  sorted_indices_.resize(count);
+
+  gridParallelFor(job_system, buckets, [this](int begin, int end) {
+    for (int b = begin; b < end; ++b) {
+      bucket_count_[b].store(0, std::memory_order_relaxed);
+    }
+  });
+
+  // Count the particles of every bucket
+  gridParallelFor(job_system, count, [this, x, y, z](int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+      uint32_t b = bucket(cellCoordinate(x[i]), cellCoordinate(y[i]), cellCoordinate(z[i]));
+      particle_buckets_[i] = b;
+      bucket_count_[b].fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+
+  // Exclusive prefix sum of the counts, each block is summed in parallel and then offset by the previous blocks
+  int blocks = (buckets + kGridChunkSize - 1) / kGridChunkSize;
+  block_sums_.resize(blocks);
+  gridParallelFor(job_system, buckets, [this](int begin, int end) {
+    int sum = 0;
+    for (int b = begin; b < end; ++b) {
+      bucket_start_[b] = sum;
+      sum += bucket_count_[b].load(std::memory_order_relaxed);
+    }
+    block_sums_[begin / kGridChunkSize] = sum;
+  });
+
+  int offset = 0;
+  for (int block = 0; block < blocks; ++block) {
+    int sum = block_sums_[block];
+    block_sums_[block] = offset;
+    offset += sum;
+  }
+  bucket_start_[buckets] = offset;
+
+  gridParallelFor(job_system, buckets, [this](int begin, int end) {
+    int block_offset = block_sums_[begin / kGridChunkSize];
+    for (int b = begin; b < end; ++b) {
+      bucket_start_[b] += block_offset;
+    }
+  });
+
+  // Scatter the particles, counting down the buckets to find their slots
+  gridParallelFor(job_system, count, [this](int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+      uint32_t b = particle_buckets_[i];
+      int slot = bucket_start_[b] + bucket_count_[b].fetch_sub(1, std::memory_order_relaxed) - 1;
+      sorted_indices_[slot] = i;
+    }
+  });
+
+  // Threads fill the buckets in any order, sorting them makes the queries deterministic
+  if (job_system != nullptr && job_system->getThreadCount() > 1) {
+    gridParallelFor(job_system, buckets, [this](int begin, int end) {
+      for (int b = begin; b < end; ++b) {
+        if (bucket_start_[b + 1] - bucket_start_[b] > 1) {
+          std::sort(sorted_indices_.begin() + bucket_start_[b], sorted_indices_.begin() + bucket_start_[b + 1]);
+        }
+      }
+    });
+  }
+  else {
+    // Filled serially from the last particle, reversing the buckets leaves them in order
+    for (int b = 0; b < buckets; ++b) {
+      std::reverse(sorted_indices_.begin() + bucket_start_[b], sorted_indices_.begin() + bucket_start_[b + 1]);
+    }
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
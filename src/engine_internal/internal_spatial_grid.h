@@ -0,0 +1,102 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+#ifndef __INTERNAL_SPATIAL_GRID_H__
+#define __INTERNAL_SPATIAL_GRID_H__
+
+// ------------------------------------------------------------------------- //
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cmath>
+#include <cstdint>
+
+class JobSystem;
+
+// ------------------------------------------------------------------------- //
+
+// Uniform grid of infinite size hashed into a table, rebuilt from the particle positions with a counting sort
+// The particles of each bucket are contiguous in the sorted indices and ordered by index, so the
+// neighbour iteration order never depends on the threads that built the grid
+class SpatialHashGrid {
+public:
+  SpatialHashGrid();
+  ~SpatialHashGrid();
+
+  // Hashes the positions in cells of cell_size, the work is split in the job system if there is one
+  void build(const float* x, const float* y, const float* z, int count, float cell_size, JobSystem* job_system);
+
+  // Calls function(index) for every particle in the 3x3x3 cells around the position
+  // Cells sharing a bucket add extra candidates, the caller filters them by distance
+  template <class Function>
+  void forEachCandidate(float x, float y, float z, Function function) const;
+
+  int getCount() const { return count_; }
+
+private:
+  int cellCoordinate(float value) const { return static_cast<int>(floorf(value * inv_cell_size_)); }
+  uint32_t bucket(int cx, int cy, int cz) const {
+    uint32_t hash = static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cy) * 19349663u ^
+      static_cast<uint32_t>(cz) * 83492791u;
+    return hash & bucket_mask_;
+  }
+
+  int count_;
+  float inv_cell_size_;
+  uint32_t bucket_mask_;
+  int bucket_capacity_;
+
+  // Bucket of every particle
+  std::vector<uint32_t> particle_buckets_;
+  // First sorted index of every bucket, with one extra entry for the end of the last one
+  std::vector<int> bucket_start_;
+  // Particles counted in every bucket, filled in parallel
+  std::unique_ptr<std::atomic<int>[]> bucket_count_;
+  // Particle indices sorted by bucket
+  std::vector<int> sorted_indices_;
+  // Partial sums of the parallel prefix sum
+  std::vector<int> block_sums_;
+
+};
+
+// ------------------------------------------------------------------------- //
+
+template <class Function>
+void SpatialHashGrid::forEachCandidate(float x, float y, float z, Function function) const {
+
+  if (count_ == 0) return;
+
+  int cx = cellCoordinate(x);
+  int cy = cellCoordinate(y);
+  int cz = cellCoordinate(z);
+
+  // Different cells may land in the same bucket, each bucket is visited once
+  uint32_t visited[27];
+  int visited_count = 0;
+
+  for (int dz = -1; dz <= 1; ++dz) {
+    for (int dy = -1; dy <= 1; ++dy) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        uint32_t b = bucket(cx + dx, cy + dy, cz + dz);
+
+        bool repeated = false;
+        for (int v = 0; v < visited_count && !repeated; ++v) {
+          repeated = visited[v] == b;
+        }
+        if (repeated) continue;
+        visited[visited_count++] = b;
+
+        for (int s = bucket_start_[b]; s < bucket_start_[b + 1]; ++s) {
+          function(sorted_indices_[s]);
+        }
+      }
+    }
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+#endif // __INTERNAL_SPATIAL_GRID_H__
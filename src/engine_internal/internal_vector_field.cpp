@@ -0,0 +1,361 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+// ------------------------------------------------------------------------- //
+
+#include "../src/engine_internal/internal_vector_field.h"
+#include "engine/random.h"
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <matrix_transform.hpp>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// ------------------------------------------------------------------------- //
+
+VectorField::VectorField() {
+
+  for (int axis = 0; axis < 3; ++axis) {
+    size_[axis] = 0;
+    data_[axis] = nullptr;
+  }
+  bounds_min_ = glm::vec3(0.0f, 0.0f, 0.0f);
+  bounds_max_ = glm::vec3(1.0f, 1.0f, 1.0f);
+
+  mapped_view_ = nullptr;
+  mapped_size_ = 0;
+  file_handle_ = nullptr;
+  mapping_handle_ = nullptr;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+VectorField::~VectorField() {
+
+  release();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void VectorField::allocate(int size_x, int size_y, int size_z) {
+
+  release();
+
+  size_[0] = size_x;
+  size_[1] = size_y;
+  size_[2] = size_z;
+
+  int samples = getSampleCount();
+  storage_.assign(samples * 3, 0.0f);
+  for (int axis = 0; axis < 3; ++axis) {
+    data_[axis] = storage_.data() + samples * axis;
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+bool VectorField::loadFile(const char* path) {
+
+  release();
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+  file_handle_ = file;
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < sizeof(VectorFieldFileHeader)) {
+    release();
+    return false;
+  }
+  mapped_size_ = static_cast<size_t>(file_size.QuadPart);
+
+  mapping_handle_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping_handle_ == nullptr) {
+    release();
+    return false;
+  }
+  mapped_view_ = MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0);
+#else
+  int file = open(path, O_RDONLY);
+  if (file < 0) return false;
+
+  struct stat file_stat;
+  if (fstat(file, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(sizeof(VectorFieldFileHeader))) {
+    close(file);
+    return false;
+  }
+  mapped_size_ = static_cast<size_t>(file_stat.st_size);
+
+  // The mapping keeps its own reference to the file
+  void* view = mmap(nullptr, mapped_size_, PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  mapped_view_ = view != MAP_FAILED ? view : nullptr;
+#endif
+
+  if (mapped_view_ == nullptr) {
+    release();
+    return false;
+  }
+
+  // Validate the header before pointing the components to the samples
+  const VectorFieldFileHeader* header = static_cast<const VectorFieldFileHeader*>(mapped_view_);
+  size_t samples = static_cast<size_t>(header->size[0]) * header->size[1] * header->size[2];
+  bool valid = memcmp(header->magic, kVectorFieldFileMagic, sizeof(kVectorFieldFileMagic)) == 0 &&
+    header->version == kVectorFieldFileVersion &&
+    header->size[0] > 0 && header->size[1] > 0 && header->size[2] > 0 &&
+    samples < (1 << 24) &&
+    mapped_size_ >= sizeof(VectorFieldFileHeader) + samples * 3 * sizeof(float);
+  if (!valid) {
+    release();
+    return false;
+  }
+
+  float* components = reinterpret_cast<float*>(static_cast<char*>(mapped_view_) + sizeof(VectorFieldFileHeader));
+  for (int axis = 0; axis < 3; ++axis) {
+    size_[axis] = static_cast<int>(header->size[axis]);
+    data_[axis] = components + samples * axis;
+  }
+  bounds_min_ = glm::vec3(header->bounds_min[0], header->bounds_min[1], header->bounds_min[2]);
+  bounds_max_ = glm::vec3(header->bounds_max[0], header->bounds_max[1], header->bounds_max[2]);
+
+  return true;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void VectorField::release() {
+
+#ifdef _WIN32
+  if (mapped_view_ != nullptr) UnmapViewOfFile(mapped_view_);
+  if (mapping_handle_ != nullptr) CloseHandle(mapping_handle_);
+  if (file_handle_ != nullptr) CloseHandle(file_handle_);
+#else
+  if (mapped_view_ != nullptr) munmap(mapped_view_, mapped_size_);
+#endif
+  mapped_view_ = nullptr;
+  mapped_size_ = 0;
+  mapping_handle_ = nullptr;
+  file_handle_ = nullptr;
+
+  storage_.clear();
+  for (int axis = 0; axis < 3; ++axis) {
+    size_[axis] = 0;
+    data_[axis] = nullptr;
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void setupVectorFieldSampler(VectorFieldSampler& sampler, const VectorField& field,
+  const glm::mat4& to_grid, bool wrap, bool force, float strength) {
+
+  for (int axis = 0; axis < 3; ++axis) {
+    sampler.field[axis] = field.data_[axis];
+    sampler.size[axis] = static_cast<float>(field.size_[axis]);
+    // glm matrices are column major
+    for (int column = 0; column < 4; ++column) {
+      sampler.to_grid[axis][column] = to_grid[column][axis];
+    }
+  }
+  sampler.stride[0] = 1.0f;
+  sampler.stride[1] = sampler.size[0];
+  sampler.stride[2] = sampler.size[0] * sampler.size[1];
+  sampler.wrap = wrap;
+  sampler.force = force;
+  sampler.strength = strength;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+glm::mat4 getVectorFieldGridTransform(const VectorField& field) {
+
+  // The first sample sits on the bounds min and the last one on the bounds max
+  glm::vec3 extent = field.bounds_max_ - field.bounds_min_;
+  glm::vec3 scale;
+  for (int axis = 0; axis < 3; ++axis) {
+    scale[axis] = extent[axis] != 0.0f ? (field.size_[axis] - 1) / extent[axis] : 0.0f;
+  }
+
+  glm::mat4 to_grid = glm::scale(glm::mat4(1.0f), scale);
+  return glm::translate(to_grid, -field.bounds_min_);
+
+}
+
+// ------------------------------------------------------------------------- //
+// ------------------------------ CURL NOISE ------------------------------- //
+// ------------------------------------------------------------------------- //
+
+// Periodic value noise with lattice^3 random values, sampled at a grid point of the curl noise resolution
+static float periodicValueNoise(const std::vector<float>& values, int lattice, int x, int y, int z) {
+
+  int grid[3] = { x, y, z };
+  int cell[3][2];
+  float weight[3];
+
+  for (int axis = 0; axis < 3; ++axis) {
+    float u = grid[axis] * lattice / static_cast<float>(kCurlNoiseResolution);
+    int first = static_cast<int>(u);
+    float t = u - first;
+    cell[axis][0] = first % lattice;
+    cell[axis][1] = (first + 1) % lattice;
+    // Quintic fade keeps the second derivative continuous between lattice cells
+    weight[axis] = t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+  }
+
+  float value = 0.0f;
+  for (int corner = 0; corner < 8; ++corner) {
+    int cx = corner & 1;
+    int cy = (corner >> 1) & 1;
+    int cz = (corner >> 2) & 1;
+    float w = (cx ? weight[0] : 1.0f - weight[0]) *
+      (cy ? weight[1] : 1.0f - weight[1]) *
+      (cz ? weight[2] : 1.0f - weight[2]);
+    value += w * values[cell[0][cx] + lattice * (cell[1][cy] + lattice * cell[2][cz])];
+  }
+
+  return value;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+// Builds the curl of a tileable noise potential, the curl of any field has no divergence
+static void buildCurlNoiseField(VectorField& field, uint32_t seed) {
+
+  const int n = kCurlNoiseResolution;
+  const int samples = n * n * n;
+  // Two octaves of noise, 8 and 16 features per tile
+  const int octaves = 2;
+  const int lattices[octaves] = { 8, 16 };
+  const float amplitudes[octaves] = { 1.0f, 0.5f };
+
+  RandomGenerator random(seed);
+  std::vector<float> potential[3];
+  for (int c = 0; c < 3; ++c) {
+    potential[c].assign(samples, 0.0f);
+  }
+
+  std::vector<float> values;
+  for (int octave = 0; octave < octaves; ++octave) {
+    int lattice = lattices[octave];
+    values.resize(lattice * lattice * lattice);
+    for (int c = 0; c < 3; ++c) {
+      random.fillFloats(values.data(), static_cast<int>(values.size()), -1.0f, 1.0f);
+      for (int z = 0; z < n; ++z) {
+        for (int y = 0; y < n; ++y) {
+          for (int x = 0; x < n; ++x) {
+            potential[c][x + n * (y + n * z)] += amplitudes[octave] * periodicValueNoise(values, lattice, x, y, z);
+          }
+        }
+      }
+    }
+  }
+
+  // Central differences wrapping around the tile
+  field.allocate(n, n, n);
+  float max_length_sq = 0.0f;
+  for (int z = 0; z < n; ++z) {
+    for (int y = 0; y < n; ++y) {
+      for (int x = 0; x < n; ++x) {
+        int x0 = (x + n - 1) % n, x1 = (x + 1) % n;
+        int y0 = (y + n - 1) % n, y1 = (y + 1) % n;
+        int z0 = (z + n - 1) % n, z1 = (z + 1) % n;
+
+        float dz_dy = potential[2][x + n * (y1 + n * z)] - potential[2][x + n * (y0 + n * z)];
+        float dy_dz = potential[1][x + n * (y + n * z1)] - potential[1][x + n * (y + n * z0)];
+        float dx_dz = potential[0][x + n * (y + n * z1)] - potential[0][x + n * (y + n * z0)];
+        float dz_dx = potential[2][x1 + n * (y + n * z)] - potential[2][x0 + n * (y + n * z)];
+        float dy_dx = potential[1][x1 + n * (y + n * z)] - potential[1][x0 + n * (y + n * z)];
+        float dx_dy = potential[0][x + n * (y1 + n * z)] - potential[0][x + n * (y0 + n * z)];
+
+        int index = field.getSampleIndex(x, y, z);
+        field.data_[0][index] = dz_dy - dy_dz;
+        field.data_[1][index] = dx_dz - dz_dx;
+        field.data_[2][index] = dy_dx - dx_dy;
+
+        float length_sq = field.data_[0][index] * field.data_[0][index] +
+          field.data_[1][index] * field.data_[1][index] +
+          field.data_[2][index] * field.data_[2][index];
+        if (length_sq > max_length_sq) max_length_sq = length_sq;
+      }
+    }
+  }
+
+  // Normalized so the turbulence strength is the maximum speed it adds
+  if (max_length_sq <= 0.0f) return;
+  float scale = 1.0f / sqrtf(max_length_sq);
+  for (int c = 0; c < 3; ++c) {
+    for (int i = 0; i < samples; ++i) {
+      field.data_[c][i] *= scale;
+    }
+  }
+
+}
+
+// ------------------------------------------------------------------------- //
+
+const VectorField* getCurlNoiseField(uint32_t seed) {
+
+  static std::mutex cache_mutex;
+  static std::map<uint32_t, std::unique_ptr<VectorField>> cache;
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+
+  std::unique_ptr<VectorField>& field = cache[seed];
+  if (!field) {
+    field.reset(new VectorField());
+    buildCurlNoiseField(*field, seed);
+  }
+
+  return field.get();
+
+}
+
+// ------------------------------------------------------------------------- //
+
+const VectorField* getVectorFieldAsset(const char* path) {
+
+  static std::mutex cache_mutex;
+  static std::map<std::string, std::unique_ptr<VectorField>> cache;
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+
+  std::unique_ptr<VectorField>& field = cache[path];
+  if (!field) {
+    std::unique_ptr<VectorField> loaded(new VectorField());
+    if (!loaded->loadFile(path)) {
+      cache.erase(path);
+      throw std::runtime_error("\nFailed to load vector field.");
+    }
+    field = std::move(loaded);
+  }
+
+  return field.get();
+
+}
+
+// ------------------------------------------------------------------------- //
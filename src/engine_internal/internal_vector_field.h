@@ -0,0 +1,106 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+#ifndef __INTERNAL_VECTOR_FIELD_H__
+#define __INTERNAL_VECTOR_FIELD_H__
+
+// ------------------------------------------------------------------------- //
+
+#include <vector>
+#include <cstdint>
+#include <glm.hpp>
+
+// ------------------------------------------------------------------------- //
+
+// Header of the vector field files, followed by the x, y and z components arrays of all the samples
+// All the values are little endian, the samples cover the bounds box with the first and last one on its faces
+struct VectorFieldFileHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t size[3];
+  float bounds_min[3];
+  float bounds_max[3];
+  uint32_t reserved;
+};
+
+static const char kVectorFieldFileMagic[4] = { 'V', 'F', 'L', 'D' };
+static const uint32_t kVectorFieldFileVersion = 1;
+
+// ------------------------------------------------------------------------- //
+
+// Regular 3D grid of vectors stored as three arrays, x varies first, then y and then z
+class VectorField {
+public:
+  VectorField();
+  ~VectorField();
+
+  // Allocates a field of the given samples per axis, all the vectors start at zero
+  void allocate(int size_x, int size_y, int size_z);
+  // Maps a vector field file in memory, the samples are used straight from the mapped file
+  // Returns false if the file can't be opened or it is not a valid vector field
+  bool loadFile(const char* path);
+  // Frees the samples and unmaps the file
+  void release();
+
+  int getSampleCount() { return size_[0] * size_[1] * size_[2]; }
+  int getSampleIndex(int x, int y, int z) { return x + size_[0] * (y + size_[1] * z); }
+
+  // Samples per axis
+  int size_[3];
+  // Vector components of every sample
+  float* data_[3];
+  // Box covered by the samples in the space of the particles that sample it
+  glm::vec3 bounds_min_;
+  glm::vec3 bounds_max_;
+
+private:
+  std::vector<float> storage_;
+
+  // Mapped file view, and on Windows the file and mapping handles
+  void* mapped_view_;
+  size_t mapped_size_;
+  void* file_handle_;
+  void* mapping_handle_;
+
+};
+
+// ------------------------------------------------------------------------- //
+
+// Everything the update kernels need to sample a vector field with trilinear filtering
+struct VectorFieldSampler {
+  const float* field[3];
+  // Samples per axis and distance between consecutive samples of each axis in the arrays, as floats
+  float size[3];
+  float stride[3];
+  // Affine transform (3x4, row major) from the particles space to grid coordinates
+  float to_grid[3][4];
+  // Tiling fields repeat out of the grid, the others are clamped to the border
+  bool wrap;
+  // Force fields accelerate the particles, the others add their velocity when moving them
+  bool force;
+  float strength;
+};
+
+// Fills a sampler for the field, to_grid maps the particles space to grid coordinates
+void setupVectorFieldSampler(VectorFieldSampler& sampler, const VectorField& field,
+  const glm::mat4& to_grid, bool wrap, bool force, float strength);
+
+// Transform from the particles space to grid coordinates of a field placed by its bounds
+glm::mat4 getVectorFieldGridTransform(const VectorField& field);
+
+// ------------------------------------------------------------------------- //
+
+// Samples per axis of the curl noise fields, power of two so they tile
+static const int kCurlNoiseResolution = 32;
+
+// Returns the tileable curl noise field of the seed, built the first time and shared afterwards
+// Vectors are divergence free with a maximum length of 1, the noise has 8 features per tile
+const VectorField* getCurlNoiseField(uint32_t seed);
+
+// Returns the field of the file, mapped the first time and shared afterwards. Throws if it can't be loaded
+const VectorField* getVectorFieldAsset(const char* path);
+
+// ------------------------------------------------------------------------- //
+
+#endif // __INTERNAL_VECTOR_FIELD_H__
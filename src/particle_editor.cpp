@@ -10,7 +10,7 @@
 #include "engine_internal/internal_app_data.h"
 
 #include <cstdlib>
-#include <ctime>
+#include <cmath>
 
 // ------------------------------------------------------------------------- //
 
@@ -20,9 +20,14 @@ ParticleEditor::ParticleEditor() {
 
   input_ = nullptr;
   camera_ = nullptr;
+  job_system_ = nullptr;
 
   active_scene_ = nullptr;
 
+  fixed_time_step_ = 1.0 / 60.0;
+  max_steps_per_frame_ = 4;
+  interpolation_alpha_ = 1.0f;
+
 }
 
 // ------------------------------------------------------------------------- //
@@ -52,10 +57,22 @@ void ParticleEditor::run() {
 
     input();
     if ((now - last_frame_time) >= fps_limit) {
-      update(accumm_delta_time);
+      // Simulate in fixed steps, a hitch can't do more than the max steps
+      int steps = 0;
+      while (accumm_delta_time >= fixed_time_step_ && steps < max_steps_per_frame_) {
+        update(fixed_time_step_);
+        accumm_delta_time -= fixed_time_step_;
+        ++steps;
+      }
+      // Drop the time that couldn't be simulated
+      if (accumm_delta_time >= fixed_time_step_) {
+        accumm_delta_time = fmod(accumm_delta_time, fixed_time_step_);
+      }
+
+      // Render between the last two simulated states
+      interpolation_alpha_ = static_cast<float>(accumm_delta_time / fixed_time_step_);
       render();
       last_frame_time = now;
-      accumm_delta_time = 0.0;
     }
 
     last_update_time = now;
@@ -67,6 +84,25 @@ void ParticleEditor::run() {
 
 // ------------------------------------------------------------------------- //
 
+void ParticleEditor::setFixedTimeStep(double time_step, int max_steps_per_frame) {
+
+  if (time_step <= 0.0 || max_steps_per_frame <= 0) return;
+
+  fixed_time_step_ = time_step;
+  max_steps_per_frame_ = max_steps_per_frame;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+float ParticleEditor::getInterpolationAlpha() {
+
+  return interpolation_alpha_;
+
+}
+
+// ------------------------------------------------------------------------- //
+
 Camera* ParticleEditor::getCamera() {
 
   return camera_;
@@ -83,12 +119,20 @@ Scene* ParticleEditor::getScene(){
 
 // ------------------------------------------------------------------------- //
 
-void ParticleEditor::init() {
+JobSystem* ParticleEditor::getJobSystem(){
+
+  return job_system_;
 
-  srand(static_cast <unsigned> (time(0)));
+}
+
+// ------------------------------------------------------------------------- //
+
+void ParticleEditor::init() {
 
 	input_ = new InputManager();
 	camera_ = new Camera();
+	job_system_ = new JobSystem();
+	job_system_->init();
 
 	if (active_scene_ == nullptr) {
 		throw std::runtime_error("\n A scene has not been set to run.");
@@ -110,6 +154,9 @@ void ParticleEditor::shutDown() {
   
   app_data_->renderLoopEnd();
 
+  job_system_->shutDown();
+  delete job_system_;
+
   delete active_scene_;
   app_data_->closeVulkan();
 
@@ -56,8 +56,10 @@ void SystemDrawParticles::addParticlesDrawCommand(int cmd_buffer_image, VkComman
 
 			auto ps = static_cast<ComponentParticleSystem*>
 				(entities[i]->getComponent(Component::ComponentKind::kComponentKind_ParticleSystem));
+			if (ps->isCulled()) continue;
 
-			for (int j = 0; j < ps->getMaxParticles(); ++j) {
+			// Only the alive particles are drawn, one draw per particle in the order of the sort system
+			for (int j = 0; j < ps->getAliveParticles(); ++j) {
 				// Dynamic offset things
 				uint32_t dynamic_offset = index * static_cast<uint32_t>
 					(material_parent->models_dynamic_alignment_);
@@ -96,21 +98,43 @@ void SystemDrawParticles::updateUniformBuffers(int current_image, std::vector<En
 	//Map memory to GPU
 	material_parent->updateSceneUBO(current_image);
 
+	// Only the alive particles are uploaded
+	int alive_particles = getAliveParticles(entities);
+
 	// Update model matrices
-	material_parent->models_ubo_.models = getParticlesModelMatrices(entities);
+	material_parent->models_ubo_.models = getParticlesModelMatrices(ParticleEditor::instance().app_data_->system_sort_);
 	// Map the memory from the CPU to GPU
-	material_parent->updateModelsUBO(current_image);
+	material_parent->updateModelsUBO(current_image, alive_particles);
 
 	// Update per object uniforms and textures
-	material_parent->specific_ubo_.packed_uniforms = getParticleMaterialsData(entities);
+	material_parent->specific_ubo_.packed_uniforms = getParticleMaterialsData(ParticleEditor::instance().app_data_->system_sort_);
 	// Map the memory from the CPU to GPU
-	material_parent->updateSpecificUBO(current_image);
+	material_parent->updateSpecificUBO(current_image, alive_particles);
 
 }
 
 // ------------------------------------------------------------------------- //
 
-glm::mat4* SystemDrawParticles::getParticlesModelMatrices(std::vector<Entity*>& entities) {
+int SystemDrawParticles::getAliveParticles(std::vector<Entity*>& entities) {
+
+	int alive_particles = 0;
+
+	for (auto entity : entities) {
+		if (hasRequiredComponents(entity)) {
+			auto ps = static_cast<ComponentParticleSystem*>
+				(entity->getComponent(Component::ComponentKind::kComponentKind_ParticleSystem));
+			if (ps->isCulled()) continue;
+			alive_particles += ps->getAliveParticles();
+		}
+	}
+
+	return alive_particles;
+
+}
+
+// ------------------------------------------------------------------------- //
+
+glm::mat4* SystemDrawParticles::getParticlesModelMatrices(SystemSort* system_sort) {
 
 	ParticleEditor::AppData* app_data = ParticleEditor::instance().app_data_;
 
@@ -118,36 +142,36 @@ glm::mat4* SystemDrawParticles::getParticlesModelMatrices(std::vector<Entity*>&
 	auto material_parent = app_data->materials_[2];
 	int index = 0;
 
-	// store all the objects models matrices
-	for (auto entity : entities) {
-		if (hasRequiredComponents(entity)) {
+	// Particles are drawn between the last two simulation steps, each system has its own when it skips updates
+	float update_alpha = ParticleEditor::instance().getInterpolationAlpha();
 
-      auto transform = static_cast<ComponentTransform*>
-        (entity->getComponent(Component::ComponentKind::kComponentKind_Transform));
+	const std::vector<ComponentParticleSystem*>& systems = system_sort->getSortedSystems();
+	const std::vector<ComponentTransform*>& transforms = system_sort->getSortedTransforms();
 
-			auto ps = static_cast<ComponentParticleSystem*>
-				(entity->getComponent(Component::ComponentKind::kComponentKind_ParticleSystem));
-			auto particles = ps->getAllParticles();
+	system_alphas_.resize(systems.size());
+	for (int s = 0; s < systems.size(); ++s) {
+		system_alphas_[s] = systems[s]->getInterpolationAlpha(update_alpha);
+	}
 
-			for (int j = 0; j < ps->getMaxParticles(); ++j) {
+	// store all the particles models matrices, in the global order of all the systems
+	for (const SystemSort::SortedParticle& sorted : system_sort->getDrawOrder()) {
+		const ParticleData& particles = systems[sorted.system]->getParticleData();
+		float alpha = system_alphas_[sorted.system];
 
-				// Do the dynamic offset things
-				model_mat = (glm::mat4*)(((uint64_t)material_parent->models_ubo_.models +
-					(index * material_parent->models_dynamic_alignment_)));
+		// Do the dynamic offset things
+		model_mat = (glm::mat4*)(((uint64_t)material_parent->models_ubo_.models +
+			(index * material_parent->models_dynamic_alignment_)));
 
-				// Update matrices
-				glm::mat4 aux_model = glm::translate(glm::mat4(1.0f), particles[j]->position_);
-				aux_model = glm::scale(aux_model, glm::vec3(0.2f, 0.2f, 0.2f));
-				
-				// PS model matrix parent transform
-				aux_model = transform->getModelMatrix() * aux_model;
+		// Update matrices
+		glm::mat4 aux_model = glm::translate(glm::mat4(1.0f), particles.getInterpolatedPosition(sorted.particle, alpha));
+		aux_model = glm::scale(aux_model, glm::vec3(ComponentParticleSystem::kParticleDrawSize));
 
-				*model_mat = aux_model;
+		// PS model matrix parent transform
+		aux_model = transforms[sorted.system]->getModelMatrix() * aux_model;
 
-				++index;
-			}
+		*model_mat = aux_model;
 
-		}
+		++index;
 	}
 
 	model_mat = (glm::mat4*)((uint64_t)material_parent->models_ubo_.models);
@@ -158,7 +182,7 @@ glm::mat4* SystemDrawParticles::getParticlesModelMatrices(std::vector<Entity*>&
 
 // ------------------------------------------------------------------------- //
 
-glm::mat4* SystemDrawParticles::getParticleMaterialsData(std::vector<Entity*>& entities) {
+glm::mat4* SystemDrawParticles::getParticleMaterialsData(SystemSort* system_sort) {
 
 	ParticleEditor::AppData* app_data = ParticleEditor::instance().app_data_;
 
@@ -167,34 +191,26 @@ glm::mat4* SystemDrawParticles::getParticleMaterialsData(std::vector<Entity*>& e
 	glm::mat4 aux = glm::mat4(0.0f);
 	int index = 0;
 
-	// store all the objects colors and texture_ids
-	for (auto entity : entities) {
-		if (hasRequiredComponents(entity)) {
-
-			auto ps = static_cast<ComponentParticleSystem*>
-				(entity->getComponent(Component::ComponentKind::kComponentKind_ParticleSystem));
-			auto particles = ps->getAllParticles();
-
-			for (int j = 0; j < ps->getMaxParticles(); ++j) {
+	const std::vector<ComponentParticleSystem*>& systems = system_sort->getSortedSystems();
 
-				// Update color
-				aux[0] = particles[j]->color_;
+	// store all the particles colors and texture_ids, in the global order of all the systems
+	for (const SystemSort::SortedParticle& sorted : system_sort->getDrawOrder()) {
+		ComponentParticleSystem* ps = systems[sorted.system];
 
-				//Update texture ids
-				aux[1] = glm::vec4(ps->getTextureID(), -1, -1, -1);
+		// Update color
+		aux[0] = ps->getParticleData().getColor(sorted.particle);
 
-				// Do the dynamic offset things
-				packed_uniforms = (glm::mat4*)(((uint64_t)material_parent->specific_ubo_.packed_uniforms
-					+ (index * material_parent->specific_dynamic_alignment_)));
+		//Update texture ids
+		aux[1] = glm::vec4(ps->getTextureID(), -1, -1, -1);
 
-				// Update uniforms
-				*packed_uniforms = aux;
+		// Do the dynamic offset things
+		packed_uniforms = (glm::mat4*)(((uint64_t)material_parent->specific_ubo_.packed_uniforms
+			+ (index * material_parent->specific_dynamic_alignment_)));
 
-				++index;
-
-			}
+		// Update uniforms
+		*packed_uniforms = aux;
 
-		}
+		++index;
 	}
 
 	packed_uniforms = (glm::mat4*)((uint64_t)material_parent->specific_ubo_.packed_uniforms);
@@ -0,0 +1,132 @@
+/*
+ *  Date: 18/10/2026
+ */
+
+// ------------------------------------------------------------------------- //
+
+#include "systems/system_sort.h"
+
+#include "components/component_transform.h"
+#include "components/component_particle_system.h"
+
+#include <algorithm>
+#include <cfloat>
+
+// ------------------------------------------------------------------------- //
+
+SystemSort::SystemSort(){
+
+	setRequiredArchetype(Entity::kArchetype_ParticleSystem);
+
+}
+
+// ------------------------------------------------------------------------- //
+
+SystemSort::~SystemSort() {
+
+
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void SystemSort::sortParticles(std::vector<Entity*>& entities) {
+
+	systems_.clear();
+	transforms_.clear();
+	draw_order_.clear();
+	heap_.clear();
+	run_keys_.clear();
+	run_begin_.clear();
+
+	// The sort keys of all the systems are squared distances to the camera in world space, so they compare between systems
+	for (auto entity : entities) {
+		if (hasRequiredComponents(entity)) {
+
+			auto ps = static_cast<ComponentParticleSystem*>
+				(entity->getComponent(Component::ComponentKind::kComponentKind_ParticleSystem));
+			if (ps->isCulled() || ps->getAliveParticles() == 0) continue;
+
+			uint32_t system = static_cast<uint32_t>(systems_.size());
+			systems_.push_back(ps);
+			transforms_.push_back(static_cast<ComponentTransform*>
+				(entity->getComponent(Component::ComponentKind::kComponentKind_Transform)));
+			run_begin_.push_back(static_cast<int>(run_keys_.size()));
+
+			const uint32_t* order = ps->getDrawOrder();
+			if (order == nullptr) {
+				for (int j = 0; j < ps->getAliveParticles(); ++j) {
+					draw_order_.push_back({ system, static_cast<uint32_t>(ps->getAliveIndex(j)) });
+				}
+			}
+			else {
+				const float* key = ps->getParticleData().sort_key_;
+				heap_.push_back({ key[order[0]], system, static_cast<int>(run_keys_.size()) });
+				for (int k = 0; k < ps->getAliveParticles(); ++k) {
+					run_keys_.push_back(key[order[k]]);
+				}
+			}
+
+		}
+	}
+	draw_order_.reserve(draw_order_.size() + run_keys_.size());
+
+	for (int head = static_cast<int>(heap_.size()) / 2 - 1; head >= 0; --head) {
+		siftDown(head);
+	}
+
+	// K-way merge of the sorted runs of every system
+	while (!heap_.empty()) {
+		RunHead& top = heap_[0];
+		const uint32_t* order = systems_[top.system]->getDrawOrder();
+		const int begin = run_begin_[top.system];
+		const int end = begin + systems_[top.system]->getAliveParticles();
+
+		// The next farthest head is a child of the top, the run is taken while it stays farther than it
+		// Systems apart from the rest are copied whole
+		float limit = -FLT_MAX;
+		if (heap_.size() > 1) limit = heap_[1].key;
+		if (heap_.size() > 2) limit = std::max(limit, heap_[2].key);
+		int next = top.next;
+		do {
+			draw_order_.push_back({ top.system, order[next - begin] });
+			++next;
+		} while (next < end && run_keys_[next] > limit);
+
+		if (next < end) {
+			top.key = run_keys_[next];
+			top.next = next;
+		}
+		else {
+			top = heap_.back();
+			heap_.pop_back();
+		}
+		if (!heap_.empty()) siftDown(0);
+	}
+
+}
+
+// ------------------------------------------------------------------------- //
+
+void SystemSort::siftDown(int head) {
+
+	// Farther first, ties go to the first system so the order doesn't depend on the heap
+	auto farther = [](const RunHead& a, const RunHead& b) {
+		return a.key > b.key || (a.key == b.key && a.system < b.system);
+	};
+
+	const int count = static_cast<int>(heap_.size());
+	RunHead moving = heap_[head];
+	for (;;) {
+		int child = head * 2 + 1;
+		if (child >= count) break;
+		if (child + 1 < count && farther(heap_[child + 1], heap_[child])) ++child;
+		if (!farther(heap_[child], moving)) break;
+		heap_[head] = heap_[child];
+		head = child;
+	}
+	heap_[head] = moving;
+
+}
+
+// ------------------------------------------------------------------------- //
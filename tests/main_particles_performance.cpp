@@ -89,6 +89,8 @@ int main() {
 		//psc1->setConstantVelocity(glm::vec3(0.0f, 0.0f, 0.1f));
 		psc1->setInitialVelocity(glm::vec3(-0.4f, -0.4f, -0.4f), glm::vec3(0.4f, 0.4f, 0.4f));
 		psc1->setParticleColor(glm::vec4(1.0f, 1.0f, 1.0f, 0.33f));
+		// The particles pull each other back after the explosion
+		psc1->setSelfGravity(0.00002f, 0.05f, 0.7f);
 
 		psc1->loadTexture("../../../resources/textures/dot.png");
 
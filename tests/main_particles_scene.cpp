@@ -83,6 +83,7 @@ int main() {
 		ps->setLifetime(5.14f);
 		ps->setParticleColor(glm::vec4(1.0f, 1.0f, 1.0f, 0.33f));
 		ps->setAlphaColorOverTime(0.0f);
+		ps->setTurbulence(0.05f, 2.0f);
 
 		ps->loadTexture("../../../resources/textures/smoke.png");
 